@@ -0,0 +1,247 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace args {
+	namespace actions {
+		struct action;
+	}
+
+	// Dynamic bitset, keeping up to 64 bits inline; most of the parsers will
+	// not need anything more.
+	class bitset {
+	public:
+		using word_type = std::uint64_t;
+		static constexpr size_t word_bits = 64;
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		size_t size() const noexcept { return size_; }
+		size_t word_count() const noexcept {
+			return (size_ + word_bits - 1) / word_bits;
+		}
+		word_type const* words() const noexcept {
+			return large_.empty() ? &small_ : large_.data();
+		}
+
+		void resize(size_t size) {
+			auto const old_count = word_count();
+			size_ = size;
+			auto const count = word_count();
+			if (count > 1 && large_.empty()) {
+				large_.resize(count);
+				if (old_count) large_.front() = small_;
+			} else if (!large_.empty()) {
+				large_.resize(std::max(count, size_t{2}));
+			}
+
+			auto const tail = size % word_bits;
+			if (tail) data()[count - 1] &= (word_type{1} << tail) - 1;
+		}
+
+		void reset() noexcept {
+			small_ = 0;
+			for (auto& word : large_)
+				word = 0;
+		}
+
+		bool test(size_t index) const noexcept {
+			return (words()[index / word_bits] >> (index % word_bits)) & 1u;
+		}
+
+		void set(size_t index, bool value = true) noexcept {
+			auto const mask = word_type{1} << (index % word_bits);
+			if (value)
+				data()[index / word_bits] |= mask;
+			else
+				data()[index / word_bits] &= ~mask;
+		}
+
+		size_t count() const noexcept {
+			size_t result{};
+			auto const bits = words();
+			for (size_t index = 0; index < word_count(); ++index)
+				result += popcount(bits[index]);
+			return result;
+		}
+
+		size_t find_first() const noexcept {
+			auto const bits = words();
+			for (size_t index = 0; index < word_count(); ++index) {
+				if (bits[index])
+					return index * word_bits + lowest_bit(bits[index]);
+			}
+			return npos;
+		}
+
+		// calls fn(index) for every bit set
+		template <typename Callback>
+		void for_each(Callback&& fn) const {
+			auto const bits = words();
+			for (size_t index = 0; index < word_count(); ++index) {
+				auto word = bits[index];
+				while (word) {
+					fn(index * word_bits + lowest_bit(word));
+					word &= word - 1;
+				}
+			}
+		}
+
+		// calls fn(index) for every bit set in both lhs and rhs
+		template <typename Callback>
+		static void for_each_and(bitset const& lhs,
+		                         bitset const& rhs,
+		                         Callback&& fn) {
+			auto const lhs_bits = lhs.words();
+			auto const rhs_bits = rhs.words();
+			auto const count = std::min(lhs.word_count(), rhs.word_count());
+			for (size_t index = 0; index < count; ++index) {
+				auto word = lhs_bits[index] & rhs_bits[index];
+				while (word) {
+					fn(index * word_bits + lowest_bit(word));
+					word &= word - 1;
+				}
+			}
+		}
+
+		static size_t count_and(bitset const& lhs, bitset const& rhs) noexcept {
+			auto const lhs_bits = lhs.words();
+			auto const rhs_bits = rhs.words();
+			auto const count = std::min(lhs.word_count(), rhs.word_count());
+			size_t result{};
+			for (size_t index = 0; index < count; ++index)
+				result += popcount(lhs_bits[index] & rhs_bits[index]);
+			return result;
+		}
+
+		// calls fn(index) for every bit set in lhs, but not in rhs
+		template <typename Callback>
+		static void for_each_and_not(bitset const& lhs,
+		                             bitset const& rhs,
+		                             Callback&& fn) {
+			auto const lhs_bits = lhs.words();
+			auto const rhs_bits = rhs.words();
+			auto const rhs_count = rhs.word_count();
+			for (size_t index = 0; index < lhs.word_count(); ++index) {
+				auto word = lhs_bits[index];
+				if (index < rhs_count) word &= ~rhs_bits[index];
+				while (word) {
+					fn(index * word_bits + lowest_bit(word));
+					word &= word - 1;
+				}
+			}
+		}
+
+		static size_t popcount(word_type word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<size_t>(__builtin_popcountll(word));
+#else
+			size_t result{};
+			for (; word; word &= word - 1)
+				++result;
+			return result;
+#endif
+		}
+
+		static size_t lowest_bit(word_type word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<size_t>(__builtin_ctzll(word));
+#else
+			size_t result{};
+			for (; !(word & 1u); word >>= 1)
+				++result;
+			return result;
+#endif
+		}
+
+	private:
+		word_type* data() noexcept {
+			return large_.empty() ? &small_ : large_.data();
+		}
+
+		word_type small_{};
+		std::vector<word_type> large_{};
+		size_t size_{};
+	};
+
+	// Relation between arguments, checked after all the arguments were
+	// parsed: at most one of members, at least one of members, or the
+	// dependency requiring dependent to be present together with dependee.
+	struct constraint {
+		enum kind_type { exclusive, at_least_one, dependency };
+
+		kind_type kind{exclusive};
+		bitset members{};
+		size_t dependent{};
+		size_t dependee{};
+	};
+
+	// Structure-of-arrays copy of the data the parser needs on the hot path.
+	// Flags live in bitsets indexed by the position of an action in the
+	// parser, all the names are packed in a single pool.
+	class action_table {
+	public:
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		struct name_ref {
+			std::uint32_t offset;
+			std::uint32_t length;
+			std::uint32_t action;
+		};
+
+		bitset needs_arg{};
+		bitset required{};
+		bitset multiple{};
+		bitset positional{};
+		// actions of action_kind::user; their names are not in the lookup
+		// tables, they are matched with the virtual action::is() instead
+		bitset user{};
+
+		size_t size() const noexcept { return positional.size(); }
+
+		// Adds names of actions not seen yet and refreshes flags of all of
+		// them, as those could change after the action was added.
+		LIBARGS_API void sync(
+		    std::vector<std::unique_ptr<actions::action>> const& actions);
+
+		size_t find(std::string_view name) const noexcept {
+			for (auto const& ref : long_names_) {
+				if (ref.length == name.length() &&
+				    std::string_view{pool_.data() + ref.offset, ref.length} ==
+				        name)
+					return ref.action;
+			}
+			return npos;
+		}
+
+		size_t find(char name) const noexcept {
+			auto const action = short_names_[static_cast<unsigned char>(name)];
+			return action ? action - 1 : npos;
+		}
+
+		size_t first_positional() const noexcept {
+			return positional.find_first();
+		}
+
+		// the first name of the action, or empty view for positionals
+		std::string_view name(size_t action) const noexcept {
+			auto const ref = first_names_[action];
+			return {pool_.data() + ref.offset, ref.length};
+		}
+
+	private:
+		std::string pool_{};
+		std::vector<name_ref> long_names_{};
+		std::vector<name_ref> first_names_{};
+		std::array<std::uint32_t, 256> short_names_{};
+	};
+}  // namespace args
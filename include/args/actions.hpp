@@ -24,6 +24,9 @@
 #endif
 
 #include <args/api.hpp>
+#include <args/instrumentation.hpp>
+#include <args/names.hpp>
+#include <args/positionals.hpp>
 
 namespace args {
 	class parser;
@@ -41,8 +44,58 @@ namespace args {
 		    std::string const& name,
 		    std::string const& value,
 		    std::string const& values);
+		LIBARGS_API parse_stats& stats(parser& p) noexcept;
+		LIBARGS_API std::string_view keep(parser& p, std::string_view value);
+		// The value itself, if it is followed by a null, a copy kept by the
+		// parser otherwise.
+		LIBARGS_API char const* null_terminated(parser& p,
+		                                        std::string_view value);
+
+		inline std::string materialize([[maybe_unused]] parser& p,
+		                               std::string_view arg) {
+			LIBARGS_COUNT(stats(p), value_copies);
+			return {arg.data(), arg.length()};
+		}
+
+		// Values held back by an action until the end of the parse, so that
+		// all of them are converted at once.
+		struct LIBARGS_API deferred {
+			virtual ~deferred();
+			virtual void flush(parser& p) = 0;
+		};
+		// True, if the parser was given an executor for long lists of values.
+		LIBARGS_API bool converts_in_bulk(parser& p) noexcept;
+		// Calls values.flush(), once the parser is done with the arguments.
+		LIBARGS_API void defer(parser& p, deferred& values);
 	}  // namespace actions
 
+	namespace detail {
+		// Conversion of many values at once, splitting the work between
+		// threads for long lists; the values are appended to the output. The
+		// first error, in the order of the values, is reported through the
+		// parser.
+#include <args/storage_types.hpp>
+#define LIBARGS_DECLARE_BULK(TYPE)                           \
+	LIBARGS_API void bulk_convert(                           \
+	    parser& p, std::vector<std::string_view> const& raw, \
+	    std::vector<TYPE>& out, std::string const& name);
+		LIBARGS_FOR_EACH_STORAGE(LIBARGS_DECLARE_BULK)
+#undef LIBARGS_DECLARE_BULK
+#undef LIBARGS_FOR_EACH_STORAGE
+#undef LIBARGS_FOR_EACH_INTEGER
+
+		template <typename Storage, typename = void>
+		constexpr bool has_bulk_convert_v = false;
+		template <typename Storage>
+		constexpr bool has_bulk_convert_v<
+		    Storage,
+		    std::void_t<decltype(bulk_convert(
+		        std::declval<parser&>(),
+		        std::declval<std::vector<std::string_view> const&>(),
+		        std::declval<std::vector<Storage>&>(),
+		        std::declval<std::string const&>()))>> = true;
+	}  // namespace detail
+
 	template <typename Storage, typename = void>
 	struct converter {};
 
@@ -77,31 +130,75 @@ namespace args {
 	    : string_converter<Storage> {
 	};
 
+	// The views are not copied: values coming through visit_view point into
+	// argv, or into answer files kept by the parser. Values coming as
+	// std::string are copied to the parser's arena first.
 	template <>
-	struct converter<std::string_view> {};
+	struct converter<std::string_view> {
+		static inline std::string_view value(parser& p,
+		                                     std::string const& arg,
+		                                     std::string const&) {
+			return actions::keep(p, arg);
+		}
+		static inline std::string_view view(parser&,
+		                                    std::string_view arg,
+		                                    std::string const&) {
+			return arg;
+		}
+	};
 
+	// Same as std::string_view; values from arguments, which are not
+	// null-terminated, are copied.
 	template <>
-	struct converter<char const*> {};
+	struct converter<char const*> {
+		static inline char const* value(parser& p,
+		                                std::string const& arg,
+		                                std::string const&) {
+			return actions::keep(p, arg).data();
+		}
+		static inline char const* view(parser& p,
+		                               std::string_view arg,
+		                               std::string const&) {
+			return actions::null_terminated(p, arg);
+		}
+	};
 
 	template <>
 	struct converter<char*> {};
 
+	enum class number_error { none, not_integer, out_of_range };
+
 	template <typename Storage>
 	struct from_chars_converter {
-		static inline Storage value(parser& p,
-		                            std::string const& arg,
-		                            std::string const& name) {
-			Storage out{};
+		// Converts without reporting anything, so that many values can be
+		// converted at once, before the first error is reported.
+		static inline number_error convert(std::string_view arg,
+		                                   Storage& out) noexcept {
 			auto first = arg.data();
 			auto last = first + arg.length();
 			auto const result = std::from_chars(first, last, out);
 
 			if (result.ec == std::errc::result_out_of_range)
-				actions::argument_out_of_range(p, name);
+				return number_error::out_of_range;
 
 			if ((result.ptr && result.ptr != last) || result.ec != std::errc{})
-				actions::argument_is_not_integer(p, name);
+				return number_error::not_integer;
 
+			return number_error::none;
+		}
+
+		static inline Storage value(parser& p,
+		                            std::string const& arg,
+		                            std::string const& name) {
+			Storage out{};
+			switch (convert(arg, out)) {
+				case number_error::out_of_range:
+					actions::argument_out_of_range(p, name);
+				case number_error::not_integer:
+					actions::argument_is_not_integer(p, name);
+				case number_error::none:
+					break;
+			}
 			return out;
 		}
 	};
@@ -126,8 +223,27 @@ namespace args {
 			using inner = converter<Storage>;
 			return inner::value(p, arg, name);
 		}
+		template <typename Inner = Storage>
+		static inline std::optional<Storage> view(parser& p,
+		                                          std::string_view arg,
+		                                          std::string const& name) {
+			return converter<Inner>::view(p, arg, name);
+		}
 	};
 
+	// Converters with a view() member take the value straight from the view
+	// given to visit_view.
+	template <typename Storage, typename = void>
+	struct converts_views : std::false_type {};
+	template <typename Storage>
+	struct converts_views<Storage,
+	                      std::void_t<decltype(&converter<Storage>::view)>>
+	    : std::true_type {};
+	template <typename Storage>
+	struct converts_views<std::optional<Storage>> : converts_views<Storage> {};
+	template <typename Storage>
+	constexpr bool converts_views_v = converts_views<Storage>::value;
+
 	template <typename Item>
 	struct simple_span {
 		template <size_t Length>
@@ -229,6 +345,17 @@ namespace args {
 	};
 
 	namespace actions {
+		// Kinds of actions built into the library. Parser uses the kind to
+		// call action_base members directly, without going through the
+		// vtable; any other action is a "user" one.
+		enum class action_kind : unsigned char {
+			user,
+			store,
+			flag,
+			callback,
+			callback_with_value
+		};
+
 		struct LIBARGS_API action {
 			virtual ~action();
 			virtual bool required() const = 0;
@@ -238,6 +365,15 @@ namespace args {
 			virtual bool needs_arg() const = 0;
 			virtual void visit(parser&) = 0;
 			virtual void visit(parser&, std::string const& /*arg*/) = 0;
+			// Called by the parser with a view on the value, which lives in
+			// the arguments or in the parser's arena, null-terminated unless
+			// the arguments are non-terminated string views; by default,
+			// copies the value and calls visit(parser&, std::string const&).
+			virtual void visit_view(parser&, std::string_view arg);
+			// Converts the value the way visit_view() would, without storing
+			// it; used to validate reloaded answer files before any of their
+			// values are applied. By default, accepts anything.
+			virtual void check(parser&, std::string_view arg);
 			virtual bool visited() const = 0;
 			virtual void meta(std::string_view s) = 0;
 			virtual std::string meta(base_translator const&) const = 0;
@@ -246,12 +382,24 @@ namespace args {
 			virtual bool is(std::string_view name) const = 0;
 			virtual bool is(char name) const = 0;
 			virtual std::vector<std::string> const& names() const = 0;
+			// Number of values a positional argument takes; unless set, it
+			// follows required() and multiple().
+			virtual void nargs(arity value);
+			virtual arity nargs() const;
+			// Puts the storage back to the value it had before the first
+			// value was given to it; used by a reload of the answer files.
+			// By default, does nothing.
+			virtual void reset();
 
 			void append_short_help(base_translator const& _,
 			                       std::string& s) const;
 			std::string help_name(base_translator const& _) const;
 
+			action_kind kind() const noexcept { return kind_; }
+
 		protected:
+			action_kind kind_{action_kind::user};
+
 			action();
 			action(action const&) = delete;
 			action(action&&);
@@ -262,8 +410,12 @@ namespace args {
 		class builder {
 			friend class ::args::parser;
 
+			parser* owner;
 			action* ptr;
-			builder(action* ptr, bool required) : ptr(ptr) { req(required); }
+			builder(parser& owner, action* ptr, bool required)
+			    : owner(&owner), ptr(ptr) {
+				req(required);
+			}
 
 		public:
 			builder(builder const&) = delete;
@@ -271,14 +423,8 @@ namespace args {
 			builder& operator=(builder const&) = delete;
 			builder& operator=(builder&&) = default;
 
-			builder& meta(std::string_view name) {
-				ptr->meta(name);
-				return *this;
-			}
-			builder& help(std::string_view dscr) {
-				ptr->help(dscr);
-				return *this;
-			}
+			LIBARGS_API builder& meta(text name);
+			LIBARGS_API builder& help(text dscr);
 			builder& multi(bool value = true) {
 				ptr->multiple(value);
 				return *this;
@@ -291,35 +437,60 @@ namespace args {
 				ptr->required(!value);
 				return *this;
 			}
+			LIBARGS_API builder& nargs(arity value);
+		};
+
+		// The value of a storage from before the first value given to it;
+		// storage, which cannot be copied, is never put back.
+		template <typename Storage>
+		class initial_value {
+			static constexpr bool copyable =
+			    std::is_copy_constructible_v<Storage> &&
+			    std::is_copy_assignable_v<Storage>;
+			std::optional<Storage> value_{};
+
+		public:
+			void remember(Storage const& current) {
+				if constexpr (copyable) {
+					if (!value_) value_.emplace(current);
+				}
+			}
+			void restore(Storage& current) const {
+				if constexpr (copyable) {
+					if (value_) current = *value_;
+				}
+			}
 		};
 
 		class action_base : public action {
-			std::vector<std::string> names_;
-			std::string meta_;
-			std::string help_;
+			name_list names_;
+			text meta_;
+			text help_;
+			mutable std::string argname_;
+			// copies for the callers of the action interface, made on demand
+			mutable std::vector<std::string> name_strings_;
+			mutable std::string help_string_;
+			std::optional<arity> nargs_;
 			bool visited_ = false;
 			bool required_ = true;
 			bool multiple_ = false;
 
-			static void pack(std::vector<std::string>&) {}
-			template <typename Name, typename... Names>
-			static void pack(std::vector<std::string>& dst,
-			                 Name&& name,
-			                 Names&&... names) {
-				dst.emplace_back(std::forward<Name>(name));
-				pack(dst, std::forward<Names>(names)...);
-			}
-
 		protected:
 			template <typename... Names>
-			action_base(Names&&... argnames) {
-				names_.reserve(sizeof...(argnames));
-				pack(names_, std::forward<Names>(argnames)...);
-			}
+			action_base(Names&&... argnames)
+			    : names_{std::forward<Names>(argnames)...} {}
 
 			void visited(bool val) { visited_ = val; }
 
-			LIBARGS_API std::string argname(parser&) const;
+			// for storage keeping a single value, which would silently be
+			// overwritten by every value after the first one; the builder
+			// reports the arity, which was cut down to one value
+			void single_value_nargs(arity value) {
+				if (value.max > 1) value.max = 1;
+				action_base::nargs(value);
+			}
+
+			LIBARGS_API std::string const& argname(parser&) const;
 
 		public:
 			void required(bool value) override { required_ = value; }
@@ -332,14 +503,25 @@ namespace args {
 				visited_ = true;
 			}
 			bool visited() const override { return visited_; }
-			void meta(std::string_view s) override { meta_ = s; }
+			void meta(std::string_view s) override { meta_ = text{s}; }
 			LIBARGS_API std::string meta(
 			    base_translator const& _) const override;
-			void help(std::string_view s) override { help_ = s; }
-			std::string const& help() const override { return help_; }
+			void help(std::string_view s) override { help_ = text{s}; }
+			std::string const& help() const override {
+				if (help_string_ != help_.view())
+					help_string_.assign(help_.view());
+				return help_string_;
+			}
+
+			// The same as the setters above, except that an args::literal
+			// is only referenced.
+			void set_meta(text s) { meta_ = std::move(s); }
+			void set_help(text s) { help_ = std::move(s); }
+			std::string_view help_text() const noexcept { return help_; }
+			name_list const& name_texts() const noexcept { return names_; }
 
 			bool is(std::string_view name) const override {
-				for (auto& argname : names_) {
+				for (auto argname : names_) {
 					if (argname.length() > 1 && argname == name) return true;
 				}
 
@@ -347,7 +529,7 @@ namespace args {
 			}
 
 			bool is(char name) const override {
-				for (auto& argname : names_) {
+				for (auto argname : names_) {
 					if (argname.length() == 1 && argname[0] == name)
 						return true;
 				}
@@ -356,46 +538,138 @@ namespace args {
 			}
 
 			std::vector<std::string> const& names() const override {
-				return names_;
+				if (name_strings_.size() != names_.size())
+					name_strings_.assign(names_.begin(), names_.end());
+				return name_strings_;
+			}
+
+			void nargs(arity value) override { nargs_ = value; }
+			arity nargs() const override {
+				if (nargs_) return *nargs_;
+				return {required_ ? 1u : 0u,
+				        multiple_ ? arity::unbounded : 1u};
 			}
 		};
 
 		template <typename Storage, typename = void*>
 		class store_action final : public action_base {
 			Storage* ptr;
+			initial_value<Storage> initial_{};
 
 		public:
 			template <typename... Names>
 			explicit store_action(Storage* dst, Names&&... names)
-			    : action_base(std::forward<Names>(names)...), ptr(dst) {}
+			    : action_base(std::forward<Names>(names)...), ptr(dst) {
+				kind_ = action_kind::store;
+			}
 
+			void nargs(arity value) override { single_value_nargs(value); }
+			using action_base::nargs;
 			bool needs_arg() const override { return true; }
 			using action::visit;
 			void visit(parser& p, std::string const& arg) override {
+				LIBARGS_COUNT(stats(p), conversions);
+				LIBARGS_STAGE(stats(p), stage::conversion);
+				initial_.remember(*ptr);
 				*ptr = converter<Storage>::value(p, arg, argname(p));
 				visited(true);
 			}
+			void visit_view(parser& p, std::string_view arg) override {
+				if constexpr (converts_views_v<Storage>) {
+					LIBARGS_COUNT(stats(p), conversions);
+					LIBARGS_STAGE(stats(p), stage::conversion);
+					initial_.remember(*ptr);
+					*ptr = converter<Storage>::view(p, arg, argname(p));
+					visited(true);
+				} else {
+					visit(p, materialize(p, arg));
+				}
+			}
+			void reset() override { initial_.restore(*ptr); }
+			void check(parser& p, std::string_view arg) override {
+				if constexpr (converts_views_v<Storage>)
+					static_cast<void>(
+					    converter<Storage>::view(p, arg, argname(p)));
+				else
+					static_cast<void>(converter<Storage>::value(
+					    p, materialize(p, arg), argname(p)));
+			}
 		};
 
+		// With an executor given to the parser, the views on the values are
+		// kept until the end of the parse and converted in one go.
 		template <typename Storage, typename Allocator>
 		class store_action<std::vector<Storage, Allocator>> final
-		    : public action_base {
+		    : public action_base,
+		      deferred {
+			static constexpr bool in_bulk =
+			    std::is_same_v<Allocator, std::allocator<Storage>> &&
+			    detail::has_bulk_convert_v<Storage>;
+
 			std::vector<Storage, Allocator>* ptr;
+			initial_value<std::vector<Storage, Allocator>> initial_{};
+			std::vector<std::string_view> pending_{};
+
+			void flush(parser& p) override {
+				if constexpr (in_bulk) {
+					auto const raw = std::move(pending_);
+					pending_.clear();
+					detail::bulk_convert(p, raw, *ptr, argname(p));
+				}
+			}
 
 		public:
 			template <typename... Names>
 			explicit store_action(std::vector<Storage, Allocator>* dst,
 			                      Names&&... names)
 			    : action_base(std::forward<Names>(names)...), ptr(dst) {
+				kind_ = action_kind::store;
 				action_base::multiple(true);
 			}
 
 			bool needs_arg() const override { return true; }
 			using action::visit;
 			void visit(parser& p, std::string const& arg) override {
+				LIBARGS_COUNT(stats(p), conversions);
+				LIBARGS_STAGE(stats(p), stage::conversion);
+				initial_.remember(*ptr);
 				ptr->push_back(converter<Storage>::value(p, arg, argname(p)));
 				visited(true);
 			}
+			void visit_view(parser& p, std::string_view arg) override {
+				if constexpr (in_bulk) {
+					if (converts_in_bulk(p)) {
+						initial_.remember(*ptr);
+						if (pending_.empty()) defer(p, *this);
+						pending_.push_back(arg);
+						visited(true);
+						return;
+					}
+				}
+
+				if constexpr (converts_views_v<Storage>) {
+					LIBARGS_COUNT(stats(p), conversions);
+					LIBARGS_STAGE(stats(p), stage::conversion);
+					initial_.remember(*ptr);
+					ptr->push_back(
+					    converter<Storage>::view(p, arg, argname(p)));
+					visited(true);
+				} else {
+					visit(p, materialize(p, arg));
+				}
+			}
+			void reset() override {
+				pending_.clear();
+				initial_.restore(*ptr);
+			}
+			void check(parser& p, std::string_view arg) override {
+				if constexpr (converts_views_v<Storage>)
+					static_cast<void>(
+					    converter<Storage>::view(p, arg, argname(p)));
+				else
+					static_cast<void>(converter<Storage>::value(
+					    p, materialize(p, arg), argname(p)));
+			}
 		};
 
 		template <typename Storage,
@@ -405,6 +679,8 @@ namespace args {
 		class store_action<std::unordered_set<Storage, Hash, Eq, Allocator>>
 		    final : public action_base {
 			std::unordered_set<Storage, Hash, Eq, Allocator>* ptr;
+			initial_value<std::unordered_set<Storage, Hash, Eq, Allocator>>
+			    initial_{};
 
 		public:
 			template <typename... Names>
@@ -412,32 +688,61 @@ namespace args {
 			    std::unordered_set<Storage, Hash, Eq, Allocator>* dst,
 			    Names&&... names)
 			    : action_base(std::forward<Names>(names)...), ptr(dst) {
+				kind_ = action_kind::store;
 				action_base::multiple(true);
 			}
 
 			bool needs_arg() const override { return true; }
 			using action::visit;
 			void visit(parser& p, std::string const& arg) override {
+				LIBARGS_COUNT(stats(p), conversions);
+				LIBARGS_STAGE(stats(p), stage::conversion);
+				initial_.remember(*ptr);
 				ptr->insert(converter<Storage>::value(p, arg, argname(p)));
 				visited(true);
 			}
+			void visit_view(parser& p, std::string_view arg) override {
+				if constexpr (converts_views_v<Storage>) {
+					LIBARGS_COUNT(stats(p), conversions);
+					LIBARGS_STAGE(stats(p), stage::conversion);
+					initial_.remember(*ptr);
+					ptr->insert(converter<Storage>::view(p, arg, argname(p)));
+					visited(true);
+				} else {
+					visit(p, materialize(p, arg));
+				}
+			}
+			void reset() override { initial_.restore(*ptr); }
+			void check(parser& p, std::string_view arg) override {
+				if constexpr (converts_views_v<Storage>)
+					static_cast<void>(
+					    converter<Storage>::view(p, arg, argname(p)));
+				else
+					static_cast<void>(converter<Storage>::value(
+					    p, materialize(p, arg), argname(p)));
+			}
 		};
 
 		template <typename Storage, typename Value>
-		class set_value : public action_base {
+		class set_value final : public action_base {
 			Storage* ptr;
+			initial_value<Storage> initial_{};
 
 		public:
 			template <typename... Names>
 			explicit set_value(Storage* dst, Names&&... names)
-			    : action_base(std::forward<Names>(names)...), ptr(dst) {}
+			    : action_base(std::forward<Names>(names)...), ptr(dst) {
+				kind_ = action_kind::flag;
+			}
 
 			bool needs_arg() const override { return false; }
 			using action::visit;
 			void visit(parser&) override {
+				initial_.remember(*ptr);
 				*ptr = Value::value;
 				visited(true);
 			}
+			void reset() override { initial_.restore(*ptr); }
 		};
 
 		namespace detail {
@@ -471,6 +776,11 @@ namespace args {
 			    std::is_invocable_v<Callable, parser&, Args...>,
 			    Args...>;
 
+			template <typename Callable>
+			constexpr bool takes_view_v =
+			    std::is_invocable_v<Callable, std::string_view> ||
+			    std::is_invocable_v<Callable, parser&, std::string_view>;
+
 #if defined(HAS_STD_CONCEPTS)
 			template <typename Callable, typename... Args>
 			concept ActionHandler =
@@ -503,18 +813,22 @@ namespace args {
 		    Callable,
 		    std::enable_if_t<detail::is_action_handler_v<Callable>>>
 #endif
-		    : public action_base {
+		    final : public action_base {
 			detail::custom_adapter<Callable> cb;
 
 		public:
 			template <typename... Names>
 			explicit custom_action(Callable&& cb, Names&&... names)
 			    : action_base(std::forward<Names>(names)...)
-			    , cb(std::move(cb)) {}
+			    , cb(std::move(cb)) {
+				kind_ = action_kind::callback;
+			}
 
 			bool needs_arg() const override { return false; }
 			using action::visit;
 			void visit(parser& p) override {
+				LIBARGS_COUNT(stats(p), callbacks);
+				LIBARGS_STAGE(stats(p), stage::callbacks);
 				cb(p);
 				visited(true);
 			}
@@ -532,21 +846,61 @@ namespace args {
 		    std::enable_if_t<
 		        detail::is_action_handler_v<Callable, std::string const&>>>
 #endif
-		    : public action_base {
-			detail::custom_adapter<Callable, std::string const&> cb;
+		    final : public action_base {
+			// callbacks taking a string_view get the view from the parser,
+			// without any copy
+			using value_type =
+			    std::conditional_t<detail::takes_view_v<Callable>,
+			                       std::string_view,
+			                       std::string const&>;
+			detail::custom_adapter<Callable, value_type> cb;
 
 		public:
 			template <typename... Names>
 			explicit custom_action(Callable&& cb, Names&&... names)
 			    : action_base(std::forward<Names>(names)...)
-			    , cb(std::move(cb)) {}
+			    , cb(std::move(cb)) {
+				kind_ = action_kind::callback_with_value;
+			}
 
 			bool needs_arg() const override { return true; }
 			using action::visit;
 			void visit(parser& p, std::string const& s) override {
+				LIBARGS_COUNT(stats(p), callbacks);
+				LIBARGS_STAGE(stats(p), stage::callbacks);
 				cb(p, s);
 				visited(true);
 			}
+			void visit_view(parser& p, std::string_view arg) override {
+				if constexpr (detail::takes_view_v<Callable>) {
+					LIBARGS_COUNT(stats(p), callbacks);
+					LIBARGS_STAGE(stats(p), stage::callbacks);
+					cb(p, arg);
+					visited(true);
+				} else {
+					visit(p, materialize(p, arg));
+				}
+			}
 		};
 	}  // namespace actions
+
+#include <args/storage_types.hpp>
+
+#define LIBARGS_EXTERN_CONVERTER(TYPE) \
+	extern template struct from_chars_converter<TYPE>;
+#define LIBARGS_EXTERN_STORAGE(TYPE)                                        \
+	extern template struct converter<TYPE>;                                 \
+	extern template struct converter<std::optional<TYPE>>;                  \
+	extern template class LIBARGS_API actions::store_action<TYPE>;          \
+	extern template class LIBARGS_API                                       \
+	    actions::store_action<std::optional<TYPE>>;                         \
+	extern template class LIBARGS_API actions::store_action<std::vector<TYPE>>;
+
+	LIBARGS_FOR_EACH_INTEGER(LIBARGS_EXTERN_CONVERTER)
+	LIBARGS_FOR_EACH_STORAGE(LIBARGS_EXTERN_STORAGE)
+
+#undef LIBARGS_EXTERN_CONVERTER
+#undef LIBARGS_EXTERN_STORAGE
+#undef LIBARGS_FOR_EACH_STORAGE
+#undef LIBARGS_FOR_EACH_INTEGER
 }  // namespace args
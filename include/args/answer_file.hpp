@@ -0,0 +1,34 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace args {
+	enum class answer_dialect {
+		// every line with anything but whitespace is a single argument
+		lines,
+		// arguments separated by whitespace, with quotes, backslash escapes
+		// and comment lines
+		tokens
+	};
+
+	// Text of an answer file and the arguments found in it. The arguments
+	// are null-terminated views into the text, which is unescaped in place,
+	// so moving the contents keeps the views valid.
+	struct answer_file_contents {
+		std::unique_ptr<char[]> text{};
+		std::vector<std::string_view> tokens{};
+
+		LIBARGS_API bool read(std::string const& path, answer_dialect dialect);
+		LIBARGS_API void assign(std::string_view text, answer_dialect dialect);
+
+	private:
+		void split(size_t length, answer_dialect dialect);
+	};
+}  // namespace args
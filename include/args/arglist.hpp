@@ -0,0 +1,139 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<ranges>)
+#include <ranges>
+#endif
+#endif
+
+namespace args {
+	namespace detail {
+		// views on the tokens, which can be given to an arglist as
+		// temporaries; containers have to outlive the parser
+#if defined(__cpp_lib_ranges)
+		template <typename Range>
+		constexpr bool borrowed_range_v = std::ranges::borrowed_range<Range>;
+#else
+		template <typename Range>
+		constexpr bool borrowed_range_v = false;
+#endif
+	}  // namespace detail
+
+	// Arguments given to the parser: argv from main(), or any contiguous
+	// range of string-like tokens, such as std::vector<std::string> or an
+	// array of std::string_view. The tokens are neither copied nor
+	// converted; the range must outlive the parser.
+	class arglist {
+		using accessor = std::string_view (*)(char const*) noexcept;
+
+		unsigned count_{};
+		char** args_{};
+		char const* tokens_{};
+		size_t stride_{};
+		accessor at_{};
+		bool terminated_{true};
+
+		template <typename Token>
+		static std::string_view token_at(char const* token) noexcept {
+			return std::string_view{*reinterpret_cast<Token const*>(token)};
+		}
+
+	public:
+		constexpr arglist() = default;
+		constexpr arglist(arglist const&) = default;
+		constexpr arglist& operator=(arglist const&) = default;
+		constexpr arglist(arglist&&) = default;
+		constexpr arglist& operator=(arglist&&) = default;
+
+		constexpr arglist(int argc, char* argv[])
+		    : count_{argc < 0 ? 0u : static_cast<unsigned>(argc)}
+		    , args_{argv} {}
+
+		constexpr arglist(unsigned argc, char* argv[])
+		    : count_{argc}, args_{argv} {}
+
+		template <typename Token,
+		          typename = std::enable_if_t<
+		              std::is_constructible_v<std::string_view, Token const&>>>
+		arglist(Token const* tokens, size_t count) noexcept
+		    : count_{static_cast<unsigned>(count)}
+		    , tokens_{reinterpret_cast<char const*>(tokens)}
+		    , stride_{sizeof(Token)}
+		    , at_{&token_at<Token>}
+		    , terminated_{std::is_same_v<Token, std::string> ||
+		                  std::is_convertible_v<Token const&, char const*>} {
+			assert(count <= std::numeric_limits<unsigned>::max());
+		}
+
+		template <typename Range,
+		          typename = std::enable_if_t<
+		              !std::is_same_v<std::decay_t<Range>, arglist>>,
+		          typename = decltype(std::size(std::declval<Range const&>())),
+		          typename Token = std::remove_cv_t<std::remove_pointer_t<
+		              decltype(std::data(std::declval<Range const&>()))>>,
+		          typename = std::enable_if_t<
+		              std::is_constructible_v<std::string_view, Token const&>>>
+		arglist(Range const& tokens) noexcept
+		    : arglist(std::data(tokens), std::size(tokens)) {}
+
+		// a temporary container would be gone before the parse
+		template <typename Range,
+		          typename = std::enable_if_t<
+		              !std::is_lvalue_reference_v<Range> &&
+		              !std::is_same_v<std::decay_t<Range>, arglist> &&
+		              !detail::borrowed_range_v<Range>>,
+		          typename = decltype(std::size(std::declval<Range const&>()))>
+		arglist(Range&& tokens) = delete;
+
+		constexpr bool empty() const noexcept { return !count_; }
+		constexpr unsigned size() const noexcept { return count_; }
+		// null, unless the arguments come from argv
+		constexpr char* const* data() const noexcept { return args_; }
+		// false for tokens, which may not be followed by a null, such as
+		// std::string_view
+		constexpr bool terminated() const noexcept { return terminated_; }
+
+		constexpr std::string_view operator[](unsigned i) const noexcept {
+			if (args_) return args_[i];
+			return at_(tokens_ + i * stride_);
+		}
+		constexpr arglist shift(unsigned n = 1) const noexcept {
+			if (n >= count_) n = count_;
+			auto copy = *this;
+			copy.count_ -= n;
+			if (args_) copy.args_ += n;
+			if (tokens_) copy.tokens_ += n * stride_;
+			return copy;
+		}
+
+		LIBARGS_API static std::string_view program_name(
+		    std::string_view arg0) noexcept;
+	};
+
+	struct args_view {
+		std::string_view progname{};
+		arglist args{};
+	};
+
+	inline args_view from_main(arglist const& args) noexcept {
+		if (args.empty()) return {};
+		auto const progname = arglist::program_name(args[0]);
+		return {progname, args.shift()};
+	}
+
+	inline args_view from_main(int argc, char* argv[]) noexcept {
+		return from_main({argc, argv});
+	}
+}  // namespace args
@@ -0,0 +1,390 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/parser.hpp>
+#include <array>
+#include <tuple>
+#include <utility>
+
+namespace args {
+	namespace detail {
+		template <typename Member>
+		struct field_traits {
+			using value_type = Member;
+			static constexpr bool flag = std::is_same_v<Member, bool>;
+			static constexpr bool required = !flag;
+			static constexpr bool multiple = false;
+			static void store(Member& dst, value_type&& value) {
+				dst = std::move(value);
+			}
+		};
+
+		template <typename Value>
+		struct field_traits<std::optional<Value>> {
+			using value_type = Value;
+			static constexpr bool flag = false;
+			static constexpr bool required = false;
+			static constexpr bool multiple = false;
+			static void store(std::optional<Value>& dst, value_type&& value) {
+				dst = std::move(value);
+			}
+		};
+
+		template <typename Value, typename Allocator>
+		struct field_traits<std::vector<Value, Allocator>> {
+			using value_type = Value;
+			static constexpr bool flag = false;
+			static constexpr bool required = true;
+			static constexpr bool multiple = true;
+			static void store(std::vector<Value, Allocator>& dst,
+			                  value_type&& value) {
+				dst.push_back(std::move(value));
+			}
+		};
+	}  // namespace detail
+
+	// Description of a single member of an options structure. A member
+	// without names is a positional argument, a bool member is a flag.
+	template <typename Struct, typename Member>
+	struct field_info {
+		using traits = detail::field_traits<Member>;
+		using value_type = typename traits::value_type;
+		using converter_type = value_type (*)(parser&,
+		                                      std::string_view,
+		                                      std::string const&);
+
+		Member Struct::*member{};
+		std::string_view long_name{};
+		char short_name{};
+		std::string_view meta_text{};
+		std::string_view help_text{};
+		bool required{traits::required};
+		converter_type converter_fn{};
+
+		constexpr field_info meta(std::string_view value) const {
+			auto copy = *this;
+			copy.meta_text = value;
+			return copy;
+		}
+		constexpr field_info help(std::string_view value) const {
+			auto copy = *this;
+			copy.help_text = value;
+			return copy;
+		}
+		constexpr field_info req(bool value = true) const {
+			auto copy = *this;
+			copy.required = value;
+			return copy;
+		}
+		constexpr field_info opt(bool value = true) const {
+			return req(!value);
+		}
+		// replaces converter<value_type> for this field
+		constexpr field_info convert(converter_type fn) const {
+			auto copy = *this;
+			copy.converter_fn = fn;
+			return copy;
+		}
+	};
+
+	template <typename Struct, typename Member>
+	constexpr field_info<Struct, Member> field(Member Struct::*member,
+	                                           std::string_view long_name = {},
+	                                           char short_name = 0) {
+		return {member, long_name, short_name};
+	}
+
+	template <typename Struct, typename Member>
+	constexpr field_info<Struct, Member> field(Member Struct::*member,
+	                                           char short_name) {
+		return {member, {}, short_name};
+	}
+
+	// Options of an aggregate, described once by a list of fields. The name
+	// lookup tables are built while the schema is constant-initialised and
+	// values are stored through the member pointers, so parsing into the
+	// structure does not create any actions. Actions describing the fields
+	// are only created for the help screen and the error messages.
+	template <typename Struct, typename... Members>
+	class struct_schema {
+	public:
+		static constexpr size_t npos = static_cast<size_t>(-1);
+		static constexpr size_t size = sizeof...(Members);
+		static_assert(size < 255, "too many fields for the short name table");
+
+		struct entry {
+			std::string_view long_name{};
+			char short_name{};
+			bool flag{};
+			bool required{};
+			bool multiple{};
+		};
+
+		constexpr explicit struct_schema(field_info<Struct, Members>... fields)
+		    : fields_{fields...}
+		    , entries_{make_entry(fields)...} {
+			for (size_t index = 0; index < size; ++index) {
+				auto const& item = entries_[index];
+				if (item.short_name) {
+					auto& slot = short_names_[static_cast<unsigned char>(
+					    item.short_name)];
+					if (!slot) slot = static_cast<unsigned char>(index + 1);
+				}
+
+				if (!item.long_name.empty()) {
+					// insertion sort, stable for repeated names
+					auto pos = long_count_++;
+					for (; pos > 0; --pos) {
+						auto const prev = long_index_[pos - 1];
+						if (!(item.long_name < entries_[prev].long_name)) break;
+						long_index_[pos] = prev;
+					}
+					long_index_[pos] = index;
+				}
+
+				if (item.long_name.empty() && !item.short_name)
+					positionals_[positional_count_++] = index;
+			}
+		}
+
+		constexpr entry const& operator[](size_t index) const noexcept {
+			return entries_[index];
+		}
+
+		constexpr size_t find(std::string_view name) const noexcept {
+			size_t first{};
+			size_t last = long_count_;
+			while (first < last) {
+				auto const middle = first + (last - first) / 2;
+				if (entries_[long_index_[middle]].long_name < name)
+					first = middle + 1;
+				else
+					last = middle;
+			}
+			if (first == long_count_ ||
+			    entries_[long_index_[first]].long_name != name)
+				return npos;
+			return long_index_[first];
+		}
+
+		constexpr size_t find(char name) const noexcept {
+			auto const index = short_names_[static_cast<unsigned char>(name)];
+			return index ? index - 1u : npos;
+		}
+
+		// Fills the structure from the arguments of the parser; errors and
+		// the help screen are reported through the parser. Returns the
+		// arguments left after the end of the options, as
+		// event_stream::rest() would.
+		arglist parse(parser& p, Struct& out) const {
+			std::array<bool, size> seen{};
+			std::array<std::string, size> names{};
+
+			auto const store = [&](size_t index, std::string_view value) {
+				seen[index] = true;
+				visit(index, [&](auto const& info) {
+					using info_type = std::decay_t<decltype(info)>;
+					using traits = typename info_type::traits;
+					if constexpr (traits::flag) {
+						out.*info.member = true;
+					} else {
+						if (names[index].empty())
+							names[index] = name_of(p, index);
+						traits::store(out.*info.member,
+						              convert(p, info, value, names[index]));
+					}
+				});
+			};
+
+			positional_cursor<arg_token> positionals{};
+			if (positional_count_) {
+				std::vector<positional_cursor<arg_token>::slot> slots{};
+				slots.reserve(positional_count_);
+				for (size_t index = 0; index < positional_count_; ++index) {
+					auto const& item = entries_[positionals_[index]];
+					slots.push_back(
+					    {positionals_[index],
+					     {item.required ? 1u : 0u,
+					      item.multiple ? arity::unbounded : 1u},
+					     0});
+				}
+				positionals.plan(std::move(slots));
+			}
+
+			lookup schema{p, *this, positionals};
+			arg_scanner scanner{p.args()};
+			scan_event ev{};
+			while (scanner.next(schema, ev)) {
+				switch (ev.kind) {
+					case scan_event::option:
+					case scan_event::positional:
+						store(ev.action_id, ev.value);
+						break;
+					case scan_event::unknown:
+						fail(p, lng::unrecognized,
+						     ev.name.empty() ? std::string{ev.value}
+						                     : dashed(ev.name));
+					case scan_event::help:
+						help(p);
+					case scan_event::missing_value:
+						fail(p, lng::needs_param, dashed(ev.name));
+					case scan_event::unexpected_value:
+						fail(p, lng::needs_no_param, dashed(ev.name));
+					case scan_event::misplaced_separator:
+						fail(p, lng::answer_file_separator, {});
+				}
+			}
+
+			for (size_t index = 0; index < size; ++index) {
+				if (entries_[index].required && !seen[index])
+					fail(p, lng::required, name_of(p, index));
+			}
+			return scanner.rest();
+		}
+
+		// Creates actions describing the fields, without any storage; used
+		// for the help screen and the usage line of the errors.
+		void describe(parser& p) const {
+			for (size_t index = 0; index < size; ++index) {
+				visit(index, [&](auto const& info) {
+					auto builder = describe(p, info);
+					if (!info.meta_text.empty()) builder.meta(info.meta_text);
+					if (!info.help_text.empty()) builder.help(info.help_text);
+					builder.req(info.required);
+					builder.multi(entries_[index].multiple);
+				});
+			}
+		}
+
+	private:
+		// The schema, as seen by the scanner; answer files and stopping at
+		// a positional argument come from the parser.
+		class lookup final : public answer_files_lookup {
+		public:
+			lookup(parser& p,
+			       struct_schema const& schema,
+			       positional_cursor<arg_token>& positionals) noexcept
+			    : answer_files_lookup{p}
+			    , schema_{schema}
+			    , positionals_{positionals} {}
+
+			size_t find(std::string_view name) override {
+				return schema_.find(name);
+			}
+			size_t find(char name) override { return schema_.find(name); }
+			bool needs_arg(size_t index) override {
+				return !schema_[index].flag;
+			}
+			bool provides_help() override { return parser_.provides_help(); }
+			positional_cursor<arg_token>& positionals() override {
+				return positionals_;
+			}
+			bool stops_at_positional() override {
+				return parser_.stops_at_positional();
+			}
+
+		private:
+			struct_schema const& schema_;
+			positional_cursor<arg_token>& positionals_;
+		};
+
+		template <typename Member>
+		static constexpr entry make_entry(
+		    field_info<Struct, Member> const& info) noexcept {
+			using traits = typename field_info<Struct, Member>::traits;
+			return {info.long_name, info.short_name, traits::flag,
+			        info.required, traits::multiple};
+		}
+
+		template <typename Fn, size_t... Index>
+		void visit(size_t index, Fn& fn, std::index_sequence<Index...>) const {
+			static_cast<void>(
+			    ((index == Index && (fn(std::get<Index>(fields_)), true)) ||
+			     ...));
+		}
+
+		template <typename Fn>
+		void visit(size_t index, Fn&& fn) const {
+			visit(index, fn, std::index_sequence_for<Members...>{});
+		}
+
+		template <typename Info>
+		static typename Info::value_type convert(parser& p,
+		                                         Info const& info,
+		                                         std::string_view value,
+		                                         std::string const& name) {
+			using value_type = typename Info::value_type;
+			if (info.converter_fn) return info.converter_fn(p, value, name);
+			if constexpr (converts_views_v<value_type>)
+				return converter<value_type>::view(p, value, name);
+			else
+				return converter<value_type>::value(
+				    p, actions::materialize(p, value), name);
+		}
+
+		template <typename Info>
+		static actions::builder describe(parser& p, Info const& info) {
+			auto const describe_names = [&](auto&& cb) {
+				char const short_name[] = {info.short_name, 0};
+				if (info.short_name && !info.long_name.empty())
+					return p.custom(cb, std::string{short_name},
+					                std::string{info.long_name});
+				if (info.short_name)
+					return p.custom(cb, std::string{short_name});
+				if (!info.long_name.empty())
+					return p.custom(cb, std::string{info.long_name});
+				return p.custom(cb);
+			};
+
+			if constexpr (Info::traits::flag)
+				return describe_names([] {});
+			else
+				return describe_names([](std::string const&) {});
+		}
+
+		static std::string dashed(std::string_view name) {
+			std::string result{name.length() == 1 ? "-" : "--"};
+			result.append(name);
+			return result;
+		}
+
+		std::string name_of(parser const& p, size_t index) const {
+			auto const& item = entries_[index];
+			// the same name the parser would use for the described action
+			if (item.short_name) return dashed({&item.short_name, 1});
+			if (!item.long_name.empty()) return dashed(item.long_name);
+
+			std::string meta{};
+			visit(index, [&](auto const& info) { meta = info.meta_text; });
+			return meta.empty() ? p.tr()(lng::def_meta) : meta;
+		}
+
+		[[noreturn]] void fail(parser& p,
+		                       lng id,
+		                       std::string_view name) const {
+			describe(p);
+			p.attach_registered();
+			p.error(p.tr()(id, name), p.parse_width());
+		}
+
+		[[noreturn]] void help(parser& p) const {
+			describe(p);
+			p.attach_registered();
+			p.help(p.parse_width());
+		}
+
+		std::tuple<field_info<Struct, Members>...> fields_;
+		std::array<entry, size> entries_;
+		std::array<unsigned char, 256> short_names_{};
+		std::array<size_t, size> long_index_{};
+		std::array<size_t, size> positionals_{};
+		size_t long_count_{};
+		size_t positional_count_{};
+	};
+
+	template <typename Struct, typename... Members>
+	struct_schema(field_info<Struct, Members>...)
+	    -> struct_schema<Struct, Members...>;
+}  // namespace args
@@ -0,0 +1,269 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <args/arglist.hpp>
+#include <args/positionals.hpp>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace args {
+	class parser;
+	namespace actions {
+		struct action;
+	}
+
+	enum class event_source { arguments, answer_file };
+
+	// Single argument, as it is found by the parser: the value together with
+	// the place it comes from.
+	struct arg_token {
+		std::string_view value{};
+		event_source source{event_source::arguments};
+		size_t index{};
+	};
+
+	// Argument without an action, passed through by parser::parse_known().
+	// The value is always the whole argument, so it can be forwarded as it
+	// is. For an unknown option in a cluster of short options, the offset
+	// points at that option inside the value; the option may take the rest
+	// of the cluster for its value. For any other argument, it is zero.
+	struct unknown_arg {
+		std::string_view value{};
+		event_source source{event_source::arguments};
+		// position of the argument in the argument list or the answer file
+		size_t index{};
+		size_t offset{};
+	};
+
+	struct parse_event {
+		// null for an argument without matching action
+		actions::action* action{};
+		// position of the action in the parser
+		size_t action_id{};
+		// name used for the argument, without the dashes; empty for
+		// positional arguments
+		std::string_view name{};
+		// value of the argument, empty for arguments without a value
+		std::string_view value{};
+		event_source source{event_source::arguments};
+		// position of the argument in the argument list or the answer file
+		size_t index{};
+	};
+
+	// Argument found by the arg_scanner. Errors in the arguments are
+	// reported as events; the owner of the scanner decides, what to do with
+	// them.
+	struct scan_event {
+		enum kind_type {
+			option,
+			positional,
+			unknown,
+			help,
+			missing_value,
+			unexpected_value,
+			// "--" read from an answer file, where it cannot end the options
+			misplaced_separator
+		};
+
+		kind_type kind{option};
+		// npos for unknown arguments
+		size_t action_id{static_cast<size_t>(-1)};
+		// name used for the argument, without the dashes; empty for
+		// positional arguments
+		std::string_view name{};
+		std::string_view value{};
+		// position of the argument in the argument list or the answer file
+		size_t index{};
+		event_source source{event_source::arguments};
+	};
+
+	// What the scanner needs to know about the arguments. Implemented for
+	// the parser, for the frozen schema_view and for struct_schema, so all
+	// of them read the arguments the same way.
+	class LIBARGS_API schema_lookup {
+	public:
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		// npos for unknown names
+		virtual size_t find(std::string_view name) = 0;
+		virtual size_t find(char name) = 0;
+		virtual bool needs_arg(size_t action) = 0;
+		virtual bool provides_help() = 0;
+		virtual positional_cursor<arg_token>& positionals() = 0;
+		// A positional argument without a place ends the options, instead
+		// of being unknown.
+		virtual bool stops_at_positional();
+		// Zero, unless answer files are used. The tokens of an opened file
+		// must stay valid until the scan is over.
+		virtual char answer_file_marker();
+		virtual std::vector<std::string_view> const& open_answer_file(
+		    std::string_view path);
+		virtual void close_answer_file();
+
+	protected:
+		~schema_lookup() = default;
+	};
+
+	// Scans the arguments against a schema_lookup: long options, clusters
+	// of short options, positional arguments, "--" and answer files. The
+	// lookup is given to each call, so the scanner can be moved around.
+	class LIBARGS_API arg_scanner {
+	public:
+		// Argument without a name or a place, which was reported by the last
+		// call to next(); its lookup can be repeated with rewind().
+		enum class stop { none, long_option, short_option, positional };
+
+		arg_scanner() = default;
+		explicit arg_scanner(arglist const& args) noexcept;
+		// Scans a single answer file, without the files it includes and
+		// without the positional arguments.
+		static arg_scanner single_file(
+		    std::vector<std::string_view> const& tokens) noexcept;
+
+		bool next(schema_lookup& lookup, scan_event& event);
+
+		// See event_stream::argument_index() and event_stream::rest().
+		size_t argument_index() const noexcept {
+			return args_.index ? args_.index - 1 : 0;
+		}
+		arglist rest() const noexcept;
+		// Number of tokens read so far, the values of the options included.
+		size_t tokens() const noexcept { return tokens_; }
+
+		stop stopped() const noexcept { return stop_; }
+		// Describes the argument of an unknown event and drops the rest of
+		// its cluster, if there is one.
+		unknown_arg pass_through(scan_event const& event);
+		// Looks up the argument, which stopped the scan, again; it is not
+		// read from its source for the second time.
+		void rewind(schema_lookup& lookup);
+
+	private:
+		struct frame {
+			arglist tokens{};
+			size_t index{};
+			event_source source{event_source::arguments};
+
+			bool next(arg_token& token) noexcept;
+		};
+
+		frame& current() noexcept {
+			return files_.empty() ? args_ : files_.back();
+		}
+		bool next_token(schema_lookup& lookup, arg_token& token);
+		void finish(schema_lookup& lookup);
+		void end_options(schema_lookup& lookup, size_t rest);
+		void long_option(schema_lookup& lookup,
+		                 arg_token const& token,
+		                 scan_event& event);
+		void short_option(schema_lookup& lookup, scan_event& event);
+		void positional(schema_lookup& lookup, arg_token const& token);
+		void push(scan_event::kind_type kind,
+		          size_t action,
+		          arg_token const& token);
+		void stopped(stop kind, arg_token const& token);
+
+		frame args_{};
+		std::vector<frame> files_{};
+		arg_token cluster_{};
+		// whole argument of the cluster, with the dash
+		std::string_view cluster_arg_{};
+		std::vector<scan_event> pending_{};
+		size_t pending_front_{};
+		size_t tokens_{};
+		bool finished_{false};
+		bool single_file_{false};
+		bool options_ended_{false};
+		size_t rest_{};
+		stop stop_{stop::none};
+		arg_token stopped_{};
+		arg_token retry_{};
+	};
+
+	// Pull-based parse: arguments are scanned only as far, as needed to
+	// produce the next event. Nothing is converted or stored, until the
+	// event is given to parser::apply.
+	class event_stream {
+	public:
+		class iterator {
+			event_stream* stream_{};
+			parse_event event_{};
+
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = parse_event;
+			using difference_type = std::ptrdiff_t;
+			using pointer = parse_event const*;
+			using reference = parse_event const&;
+
+			iterator() = default;
+			explicit iterator(event_stream* stream) : stream_{stream} {
+				++*this;
+			}
+
+			reference operator*() const noexcept { return event_; }
+			pointer operator->() const noexcept { return &event_; }
+			iterator& operator++() {
+				if (stream_ && !stream_->next(event_)) stream_ = nullptr;
+				return *this;
+			}
+			bool operator==(iterator const& rhs) const noexcept {
+				return stream_ == rhs.stream_;
+			}
+			bool operator!=(iterator const& rhs) const noexcept {
+				return stream_ != rhs.stream_;
+			}
+		};
+
+		LIBARGS_API explicit event_stream(parser& p);
+		event_stream(event_stream const&) = delete;
+		event_stream& operator=(event_stream const&) = delete;
+		event_stream(event_stream&&) = default;
+		event_stream& operator=(event_stream&&) = default;
+
+		LIBARGS_API bool next(parse_event& event);
+
+		iterator begin() { return iterator{this}; }
+		iterator end() { return {}; }
+
+		// Index of the command line argument currently scanned; for events
+		// coming from answer files, it is the index of the outermost answer
+		// file.
+		size_t argument_index() const noexcept {
+			return scanner_.argument_index();
+		}
+
+		// Command line arguments left after the end of the options, as a
+		// slice of the original arguments: the ones after a "--", or the
+		// positional argument, which ended the options together with the
+		// ones after it. Empty, until the options end; nothing in the
+		// slice is scanned.
+		arglist rest() const noexcept { return scanner_.rest(); }
+
+	private:
+		friend class parser;
+
+		// Scans a single answer file again, without the files it includes
+		// and without the positional arguments.
+		event_stream(parser& p, std::vector<std::string_view> const& tokens);
+
+		// Describes the argument of an event without an action and drops
+		// the rest of its cluster, if there is one.
+		unknown_arg pass_through(parse_event const& event);
+		// Looks for the action of the argument, which stopped the stream,
+		// again, with the actions added since.
+		void rewind();
+
+		parser* parser_;
+		arg_scanner scanner_{};
+		// the event, which stopped the stream, and the number of actions
+		// it was looked up with
+		parse_event unknown_{};
+		size_t stopped_actions_{};
+	};
+}  // namespace args
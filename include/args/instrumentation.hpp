@@ -0,0 +1,80 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace args {
+	enum class stage : int {
+		parse,
+		answer_files,
+		conversion,
+		callbacks,
+		validation,
+		printer
+	};
+
+	inline constexpr size_t stage_count = 6;
+
+	struct parse_stats {
+		size_t tokens{};
+		size_t lookups{};
+		size_t conversions{};
+		size_t callbacks{};
+		// not a count of heap allocations: actions created by the parser
+		// and values copied out of the arguments, whatever their length
+		size_t actions{};
+		size_t value_copies{};
+		size_t answer_files{};
+		std::array<std::chrono::nanoseconds, stage_count> timers{};
+
+		std::chrono::nanoseconds time(stage id) const noexcept {
+			return timers[static_cast<size_t>(id)];
+		}
+	};
+
+	using stats_sink = std::function<void(parse_stats const&)>;
+
+	namespace instrumentation {
+#if defined(LIBARGS_INSTRUMENTATION)
+		inline constexpr bool enabled = true;
+
+		class timer {
+			using clock = std::chrono::steady_clock;
+
+			parse_stats& stats_;
+			stage id_;
+			clock::time_point start_{clock::now()};
+
+		public:
+			timer(parse_stats& stats, stage id) noexcept
+			    : stats_{stats}, id_{id} {}
+			timer(timer const&) = delete;
+			timer& operator=(timer const&) = delete;
+			~timer() {
+				stats_.timers[static_cast<size_t>(id_)] +=
+				    std::chrono::duration_cast<std::chrono::nanoseconds>(
+				        clock::now() - start_);
+			}
+		};
+#else
+		inline constexpr bool enabled = false;
+#endif
+	}  // namespace instrumentation
+}  // namespace args
+
+// Both macros vanish completely, together with their arguments, unless the
+// library is compiled with LIBARGS_INSTRUMENTATION.
+#if defined(LIBARGS_INSTRUMENTATION)
+#define LIBARGS_COUNT(STATS, COUNTER) (++(STATS).COUNTER)
+#define LIBARGS_STAGE(STATS, STAGE) \
+	::args::instrumentation::timer libargs_stage_timer { STATS, STAGE }
+#else
+#define LIBARGS_COUNT(STATS, COUNTER) ((void)0)
+#define LIBARGS_STAGE(STATS, STAGE) ((void)0)
+#endif
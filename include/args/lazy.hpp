@@ -0,0 +1,147 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/actions.hpp>
+
+namespace args {
+	// Storage converting the value only when it is read for the first time.
+	// Parsing records the view on the last value given; a conversion error
+	// is reported by the parser on first access, so the parser must still
+	// exist by then.
+	template <typename Storage>
+	class lazy {
+		parser* parser_{};
+		std::string const* name_{};
+		std::string_view raw_{};
+		mutable std::optional<Storage> value_{};
+
+		template <typename, typename>
+		friend class actions::store_action;
+
+		void bind(parser& p, std::string_view raw, std::string const& name) {
+			parser_ = &p;
+			name_ = &name;
+			raw_ = raw;
+			value_.reset();
+		}
+
+	public:
+		static constexpr bool multiple = false;
+
+		lazy() = default;
+		explicit lazy(Storage fallback) : value_{std::move(fallback)} {}
+
+		bool has_value() const noexcept { return parser_ != nullptr; }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		// the value seen on the command line, not converted yet
+		std::string_view raw() const noexcept { return raw_; }
+
+		Storage const& get() const {
+			if (!value_) {
+				if (!parser_) {
+					value_.emplace();
+				} else {
+					LIBARGS_COUNT(actions::stats(*parser_), conversions);
+					LIBARGS_STAGE(actions::stats(*parser_), stage::conversion);
+					value_ = converter<Storage>::value(
+					    *parser_, actions::materialize(*parser_, raw_), *name_);
+				}
+			}
+			return *value_;
+		}
+
+		Storage const& operator*() const { return get(); }
+		Storage const* operator->() const { return &get(); }
+	};
+
+	// Keeps the views on all the values; all of them are converted on first
+	// access, in one go.
+	template <typename Storage>
+	class lazy<std::vector<Storage>> {
+		parser* parser_{};
+		std::string const* name_{};
+		std::vector<std::string_view> raw_{};
+		mutable std::optional<std::vector<Storage>> value_{};
+
+		template <typename, typename>
+		friend class actions::store_action;
+
+		void bind(parser& p, std::string_view raw, std::string const& name) {
+			parser_ = &p;
+			name_ = &name;
+			raw_.push_back(raw);
+			value_.reset();
+		}
+
+	public:
+		static constexpr bool multiple = true;
+
+		bool has_value() const noexcept { return parser_ != nullptr; }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		std::vector<std::string_view> const& raw() const noexcept {
+			return raw_;
+		}
+
+		std::vector<Storage> const& get() const {
+			if (value_) return *value_;
+
+			auto& out = value_.emplace();
+			if (!parser_) return out;
+
+			if constexpr (detail::has_bulk_convert_v<Storage>) {
+				detail::bulk_convert(*parser_, raw_, out, *name_);
+			} else {
+				LIBARGS_STAGE(actions::stats(*parser_), stage::conversion);
+				out.reserve(raw_.size());
+				for (auto raw : raw_) {
+					LIBARGS_COUNT(actions::stats(*parser_), conversions);
+					out.push_back(converter<Storage>::value(
+					    *parser_, actions::materialize(*parser_, raw), *name_));
+				}
+			}
+			return out;
+		}
+
+		std::vector<Storage> const& operator*() const { return get(); }
+		std::vector<Storage> const* operator->() const { return &get(); }
+	};
+
+	namespace actions {
+		template <typename Storage>
+		class store_action<lazy<Storage>> final : public action_base {
+			lazy<Storage>* ptr;
+			initial_value<lazy<Storage>> initial_{};
+
+		public:
+			template <typename... Names>
+			explicit store_action(lazy<Storage>* dst, Names&&... names)
+			    : action_base(std::forward<Names>(names)...), ptr(dst) {
+				kind_ = action_kind::store;
+				action_base::multiple(lazy<Storage>::multiple);
+			}
+
+			void nargs(arity value) override {
+				if constexpr (lazy<Storage>::multiple)
+					action_base::nargs(value);
+				else
+					single_value_nargs(value);
+			}
+			using action_base::nargs;
+			bool needs_arg() const override { return true; }
+			using action::visit;
+			void visit(parser& p, std::string const& arg) override {
+				visit_view(p, keep(p, arg));
+			}
+			void visit_view(parser& p, std::string_view arg) override {
+				initial_.remember(*ptr);
+				ptr->bind(p, arg, argname(p));
+				visited(true);
+			}
+			void reset() override { initial_.restore(*ptr); }
+		};
+	}  // namespace actions
+}  // namespace args
@@ -0,0 +1,188 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace args {
+	// Text known to outlive the parser, like a string literal. Given as a
+	// name, a meta or a help text, it is referenced instead of copied; its
+	// text ends at the first null, not at the end of the array.
+	class literal {
+		std::string_view view_{};
+
+	public:
+		template <size_t Length>
+		constexpr literal(char const (&chars)[Length]) noexcept
+		    : view_{chars, std::char_traits<char>::length(chars)} {}
+		constexpr explicit literal(std::string_view chars) noexcept
+		    : view_{chars} {}
+
+		constexpr std::string_view view() const noexcept { return view_; }
+		constexpr operator std::string_view() const noexcept { return view_; }
+	};
+
+	namespace literals {
+		constexpr literal operator""_lit(char const* chars,
+		                                 size_t length) noexcept {
+			return literal{std::string_view{chars, length}};
+		}
+	}  // namespace literals
+
+	// Text given to the parser while defining the options. It is copied,
+	// so that the caller does not have to keep it, unless it comes as an
+	// args::literal.
+	class text {
+		char const* literal_{};
+		size_t length_{};
+		std::string copy_{};
+
+	public:
+		text() = default;
+
+		text(literal chars) noexcept
+		    : literal_{chars.view().data()}, length_{chars.view().length()} {}
+
+		text(char const* chars) : copy_{chars} {}
+
+		template <typename Chars,
+		          typename = std::enable_if_t<
+		              !std::is_array_v<Chars> &&
+		              std::is_convertible_v<Chars const&, char const*>>>
+		text(Chars const& chars) : copy_{static_cast<char const*>(chars)} {}
+
+		text(std::string_view chars) : copy_{chars} {}
+		text(std::string chars) : copy_{std::move(chars)} {}
+
+		std::string_view view() const noexcept {
+			if (literal_) return {literal_, length_};
+			return copy_;
+		}
+		operator std::string_view() const noexcept { return view(); }
+
+		bool empty() const noexcept { return view().empty(); }
+		size_t length() const noexcept { return view().length(); }
+		char operator[](size_t index) const noexcept { return view()[index]; }
+		bool operator==(std::string_view rhs) const noexcept {
+			return view() == rhs;
+		}
+		bool operator!=(std::string_view rhs) const noexcept {
+			return view() != rhs;
+		}
+	};
+
+	namespace detail {
+		// Iterates over any list of names with size() and operator[].
+		template <typename List>
+		class name_iterator {
+			List const* list_{};
+			size_t index_{};
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = std::string_view;
+
+			name_iterator() = default;
+			name_iterator(List const* list, size_t index)
+			    : list_{list}, index_{index} {}
+
+			std::string_view operator*() const noexcept {
+				return (*list_)[index_];
+			}
+			name_iterator& operator++() noexcept {
+				++index_;
+				return *this;
+			}
+			name_iterator operator++(int) noexcept {
+				auto copy = *this;
+				++index_;
+				return copy;
+			}
+			bool operator==(name_iterator const& rhs) const noexcept {
+				return index_ == rhs.index_;
+			}
+			bool operator!=(name_iterator const& rhs) const noexcept {
+				return index_ != rhs.index_;
+			}
+		};
+	}  // namespace detail
+
+	// Names of a single option. Up to three names are kept inside the list,
+	// so together with short or literal names, the list does not need the
+	// heap.
+	class name_list {
+	public:
+		static constexpr size_t inline_capacity = 3;
+		using iterator = detail::name_iterator<name_list>;
+
+		name_list() = default;
+
+		template <typename... Names>
+		explicit name_list(Names&&... names) {
+			if constexpr (sizeof...(Names) > inline_capacity)
+				more_.reserve(sizeof...(Names) - inline_capacity);
+			(push_back(text{std::forward<Names>(names)}), ...);
+		}
+
+		void push_back(text name) {
+			if (size_ < inline_capacity)
+				inline_[size_] = std::move(name);
+			else
+				more_.push_back(std::move(name));
+			++size_;
+		}
+
+		size_t size() const noexcept { return size_; }
+		bool empty() const noexcept { return !size_; }
+		std::string_view operator[](size_t index) const noexcept {
+			return index < inline_capacity ? inline_[index].view()
+			                               : more_[index - inline_capacity].view();
+		}
+		std::string_view front() const noexcept { return (*this)[0]; }
+
+		iterator begin() const noexcept { return {this, 0}; }
+		iterator end() const noexcept { return {this, size_}; }
+
+	private:
+		std::array<text, inline_capacity> inline_{};
+		std::vector<text> more_{};
+		size_t size_{};
+	};
+
+	// Names of any action: the name list of the actions built into the
+	// library, or the strings of a user action.
+	class names_view {
+		name_list const* list_{};
+		std::vector<std::string> const* strings_{};
+
+	public:
+		using iterator = detail::name_iterator<names_view>;
+
+		names_view(name_list const& list) noexcept : list_{&list} {}
+		names_view(std::vector<std::string> const& strings) noexcept
+		    : strings_{&strings} {}
+
+		size_t size() const noexcept {
+			return list_ ? list_->size() : strings_->size();
+		}
+		bool empty() const noexcept { return !size(); }
+		std::string_view operator[](size_t index) const noexcept {
+			if (list_) return (*list_)[index];
+			return (*strings_)[index];
+		}
+		std::string_view front() const noexcept { return (*this)[0]; }
+
+		iterator begin() const noexcept { return {this, 0}; }
+		iterator end() const noexcept { return {this, size()}; }
+	};
+}  // namespace args
@@ -3,63 +3,27 @@
 
 #pragma once
 
+#include <args/action_table.hpp>
 #include <args/actions.hpp>
+#include <args/answer_file.hpp>
+#include <args/arglist.hpp>
+#include <args/events.hpp>
+#include <args/instrumentation.hpp>
+#include <args/lazy.hpp>
+#include <args/positionals.hpp>
 #include <args/printer.hpp>
+#include <args/registry.hpp>
 #include <args/translator.hpp>
 #include <args/version.hpp>
 
+#include <forward_list>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include <unordered_map>
 
 namespace args {
-	class arglist {
-		unsigned count_{};
-		char** args_{};
-
-	public:
-		constexpr arglist() = default;
-		constexpr arglist(arglist const&) = default;
-		constexpr arglist& operator=(arglist const&) = default;
-		constexpr arglist(arglist&&) = default;
-		constexpr arglist& operator=(arglist&&) = default;
-
-		constexpr arglist(int argc, char* argv[])
-		    : count_{argc < 0 ? 0u : static_cast<unsigned>(argc)}
-		    , args_{argv} {}
-
-		constexpr arglist(unsigned argc, char* argv[])
-		    : count_{argc}, args_{argv} {}
-
-		constexpr bool empty() const noexcept { return !count_; }
-		constexpr unsigned size() const noexcept { return count_; }
-		constexpr char* const* data() const noexcept { return args_; }
-
-		constexpr std::string_view operator[](unsigned i) const noexcept {
-			return args_[i];
-		}
-		constexpr arglist shift(unsigned n = 1) const noexcept {
-			if (n >= count_) n = count_;
-			return {count_ - n, args_ + n};
-		}
-
-		LIBARGS_API static std::string_view program_name(
-		    std::string_view arg0) noexcept;
-	};
-
-	struct args_view {
-		std::string_view progname{};
-		arglist args{};
-	};
-
-	inline args_view from_main(arglist const& args) noexcept {
-		if (args.empty()) return {};
-		auto const progname = arglist::program_name(args[0]);
-		return {progname, args.shift()};
-	}
-
-	inline args_view from_main(int argc, char* argv[]) noexcept {
-		return from_main({argc, argv});
-	}
-
 #if defined(HAS_STD_CONCEPTS)
 	// can I build a string out of it?
 	template <typename NameType>
@@ -76,51 +40,117 @@ namespace args {
 	    actions::detail::is_action_handler_v<Callable, std::string const&>;
 #endif
 
+	struct answer_watch;
+	class answer_files_lookup;
+	namespace detail {
+		class action_lookup;
+	}
+
 	class parser {
 	public:
 		enum unknown_action { exclusive_parser = 0, allow_subcommands = 1 };
+		// Calls task(0) ... task(count - 1), possibly in parallel, and
+		// returns once all of them are done.
+		using bulk_executor = std::function<void(
+		    size_t count, std::function<void(size_t)> const& task)>;
+		using reload_callback =
+		    std::function<void(std::vector<std::string> const& changed)>;
+		using reload_error_callback = std::function<void(
+		    std::string const& path, std::string const& message)>;
 
 	private:
 		std::vector<std::unique_ptr<actions::action>> actions_;
+		// built when a parse starts; see start_parse()
+		action_table table_{};
+		bitset visited_{};
+		positional_cursor<arg_token> positionals_{};
+		std::vector<constraint> constraints_{};
+		option_registry registry_{};
+		bitset attached_{};
+		std::unordered_map<std::string, answer_file_contents> answer_cache_{};
+		// answer files read by previous parses and values copied by keep();
+		// string views stored by actions may still point into them
+		std::vector<answer_file_contents> answer_arena_{};
+		std::forward_list<std::string> arena_{};
+		std::vector<std::pair<std::string, std::string>> answer_chain_{};
+		size_t max_answer_file_depth_{16};
+		std::shared_ptr<answer_watch> watch_{};
 		std::string description_;
 		arglist args_;
 		std::string prog_;
 		std::string usage_;
+		std::string usage_suffix_;
+		std::function<void(fmt_list&)> help_sections_{};
 		bool provide_help_ = true;
+		bool stop_at_positional_ = false;
+		// errors and help throw instead of exiting, while a reload is tried
+		bool reloading_ = false;
 		char answer_file_marker_{};
+		answer_dialect answer_dialect_{answer_dialect::lines};
 		std::optional<size_t> parse_width_ = {};
+		std::optional<size_t> default_width_ = {};
 		base_translator const* tr_;
+		mutable parse_stats stats_{};
+		stats_sink stats_sink_{};
+		bulk_executor executor_{};
 		[[nodiscard]] std::string _(lng id,
 		                            std::string_view arg1 = {},
 		                            std::string_view arg2 = {}) const {
 			return (*tr_)(id, arg1, arg2);
 		}
 
-		[[nodiscard]] std::pair<size_t, size_t> count_args() const noexcept;
-
-		template <typename ArgList>
-		bool parse_list(ArgList& list, unknown_action on_unknown);
-		template <typename ArgList>
-		bool parse_long(ArgList& list, unknown_action on_unknown);
-		template <typename ArgList>
-		bool parse_short(ArgList& list, unknown_action on_unknown);
-		bool parse_positional(std::string const& value,
-		                      unknown_action on_unknown);
-		bool parse_answer_file(std::string const& value,
-		                       unknown_action on_unknown);
+		[[nodiscard]] std::pair<size_t, size_t> count_args() const;
+		[[nodiscard]] size_t find_action(std::string_view name) const;
+		[[nodiscard]] std::string argument_name(size_t index) const;
+		void add_group(constraint::kind_type kind,
+		               std::initializer_list<std::string_view> names);
+		[[nodiscard]] size_t constraint_member(std::string_view name) const;
+		void check_constraints(std::string& violations) const;
+		void plan_positionals();
+		void check_positionals(std::string& violations) const;
+
+		friend class event_stream;
+		friend class answer_files_lookup;
+		friend class detail::action_lookup;
+		friend void actions::defer(parser&, actions::deferred&);
+		// the actions waiting for the end of the parse to convert values
+		std::vector<actions::deferred*> deferred_{};
+		void convert_deferred();
+		void start_parse();
+		void extend_parse(size_t known_actions);
+		answer_file_contents const& open_answer_file(std::string const& path);
+		void close_answer_file();
+		std::vector<parse_event> rescan(
+		    std::vector<std::string_view> const& tokens);
+		void reapply(std::vector<size_t> const& changed,
+		             size_t reloaded,
+		             std::vector<parse_event> const& events);
+		void release_generations(std::vector<size_t> const& changed);
+		size_t lookup(std::string_view name);
+		size_t lookup(char name);
+		size_t attach_registered_at(size_t registered);
+		template <typename Name>
+		size_t attach_registered(Name name) {
+			return attach_registered_at(registry_.find(name));
+		}
+		[[noreturn]] void unrecognized(parse_event const& event);
+		[[noreturn]] void argument_error(lng id, std::string_view name);
+		void report_stats() const;
 
 		template <typename Action, typename... Args>
 		actions::builder add(Args&&... args) {
+			LIBARGS_COUNT(stats_, actions);
 			actions_.push_back(
 			    std::make_unique<Action>(std::forward<Args>(args)...));
-			return {actions_.back().get(), true};
+			return {*this, actions_.back().get(), true};
 		}
 
 		template <typename Action, typename... Args>
 		actions::builder add_opt(Args&&... args) {
+			LIBARGS_COUNT(stats_, actions);
 			actions_.push_back(
 			    std::make_unique<Action>(std::forward<Args>(args)...));
-			return {actions_.back().get(), false};
+			return {*this, actions_.back().get(), false};
 		}
 
 	public:
@@ -187,33 +217,163 @@ namespace args {
 			    std::move(cb), std::forward<Names>(names)...);
 		}
 
+		template <typename Callable>
+#if defined(HAS_STD_CONCEPTS)
+		requires actions::detail::ActionHandler<
+		    Callable,
+		    std::string const&> actions::builder
+#else
+		std::enable_if_t<
+		    actions::detail::is_action_handler_v<Callable, std::string const&>,
+		    actions::builder>
+#endif
+		    stream(Callable cb) {
+			auto result = add_opt<actions::custom_action<Callable>>(std::move(cb));
+			result.multi();
+			return result;
+		}
+
+		// Adds an action of a type defined outside of the library. Its
+		// names are matched with the virtual action::is(), and a visited()
+		// action counts as given, when the arguments are validated.
+		template <typename Action, typename... Args>
+		actions::builder add_action(Args&&... args) {
+			return add<Action>(std::forward<Args>(args)...);
+		}
+
+		LIBARGS_API void mutually_exclusive(
+		    std::initializer_list<std::string_view> names);
+		LIBARGS_API void at_least_one(
+		    std::initializer_list<std::string_view> names);
+		LIBARGS_API void depends(std::string_view name,
+		                         std::string_view dependency);
+
 		LIBARGS_API void program(std::string const& value);
 		LIBARGS_API std::string const& program() const noexcept;
 
 		LIBARGS_API void usage(std::string_view value);
 		LIBARGS_API std::string const& usage() const noexcept;
 
+		// Adds things, which are not arguments of this parser, like the
+		// subcommands, to the usage line and to the help screen; the
+		// sections are only built, when the help is printed.
+		void extend_help(std::string usage_suffix,
+		                 std::function<void(fmt_list&)> sections) {
+			usage_suffix_ = std::move(usage_suffix);
+			help_sections_ = std::move(sections);
+		}
+
 		void provide_help(bool value = true) { provide_help_ = value; }
 		bool provides_help() const noexcept { return provide_help_; }
 
-		void use_answer_file(char marker = '@') {
+		// The first positional argument on the command line, which none of
+		// the positional actions takes, ends the options, as it would with
+		// POSIXLY_CORRECT getopt; it is left for event_stream::rest().
+		void stop_at_positional(bool value = true) {
+			stop_at_positional_ = value;
+		}
+		bool stops_at_positional() const noexcept {
+			return stop_at_positional_;
+		}
+
+		void use_answer_file(char marker = '@',
+		                     answer_dialect dialect = answer_dialect::lines) {
 			answer_file_marker_ = marker;
+			answer_dialect_ = dialect;
 		}
 		bool uses_answer_file() const noexcept {
 			return answer_file_marker_ != 0;
 		}
 		char answer_file_marker() const noexcept { return answer_file_marker_; }
+		answer_dialect answer_file_dialect() const noexcept {
+			return answer_dialect_;
+		}
+		void max_answer_file_depth(size_t depth) {
+			max_answer_file_depth_ = depth;
+		}
+		size_t max_answer_file_depth() const noexcept {
+			return max_answer_file_depth_;
+		}
 
 		arglist const& args() const noexcept { return args_; }
 
 		base_translator const& tr() const noexcept { return *tr_; }
 
+		// Width used by the parses, which are not given one; the parsers
+		// of subcommands get the width of the level above.
+		void default_width(std::optional<size_t> width) noexcept {
+			default_width_ = width;
+		}
 		std::optional<size_t> parse_width() const noexcept {
 			return parse_width_;
 		}
 
+		// Options registered with ARGS_REGISTER_OPTION are added to the
+		// parser only when they are seen in the arguments; the help screen
+		// and attach_registered() add all of them. Call it before help() or
+		// error(), for the usage to list them; while a reload is tried,
+		// nothing is printed and nothing is attached.
+		void use_registry(option_registry registry) {
+			registry_ = registry;
+			attached_.resize(registry.size());
+			attached_.reset();
+		}
+		LIBARGS_API void attach_registered();
+
+		// Copies the value into memory owned by the parser; the view stays
+		// valid and null-terminated until the parser is destroyed or the
+		// arena is released.
+		LIBARGS_API std::string_view keep(std::string_view value);
+		// Frees the values copied by keep() and the answer files read by
+		// the parses before the last one, and stops watching the answer
+		// files. No view handed out by those parses may be used afterwards.
+		LIBARGS_API void release_arena();
+
+		// Lets long lazy vectors of numbers and strings be converted in
+		// parts on the caller's threads; without one, they are converted
+		// on the thread reading them.
+		void use_executor(bulk_executor run) { executor_ = std::move(run); }
+		bulk_executor const& executor() const noexcept { return executor_; }
+
+		parse_stats const& stats() const noexcept { return stats_; }
+		parse_stats& stats() noexcept { return stats_; }
+		void on_stats(stats_sink sink) { stats_sink_ = std::move(sink); }
+
 		LIBARGS_API arglist parse(unknown_action on_unknown = exclusive_parser,
 		                          std::optional<size_t> maybe_width = {});
+		// Applies the arguments with an action, passing all the other ones
+		// to the unknown list, which is cleared first.
+		LIBARGS_API arglist parse_known(std::vector<unknown_arg>& unknown,
+		                                std::optional<size_t> maybe_width = {});
+
+		// Pull-based parse: the events must be given to apply() to have any
+		// effect, and validate() checks the arguments applied so far.
+		LIBARGS_API event_stream events(std::optional<size_t> maybe_width = {});
+		LIBARGS_API void apply(parse_event const& event);
+		LIBARGS_API void validate();
+
+		// Multi-phase parse: applies the events until the first argument
+		// without an action, and returns it. Actions added before the next
+		// call are looked up for that argument and for the rest of the
+		// stream; if there are none, the argument is reported as an error.
+		// Returns nothing, once all arguments are applied and validated.
+		LIBARGS_API std::optional<parse_event> resume(event_stream& stream);
+
+		// Watches the answer files read by the last parse. A reload re-reads
+		// only the changed files and applies only the options, whose values
+		// changed there; their names are given to the callback. A file,
+		// which does not parse, is not applied at all and is reported to
+		// the error callback instead. The handle can be polled for
+		// readability, before calling the reload.
+		LIBARGS_API void watch_answer_files(
+		    reload_callback callback,
+		    reload_error_callback on_error = {});
+		LIBARGS_API int answer_files_handle() const noexcept;
+		LIBARGS_API size_t reload_answer_files();
+
+		// Serialises the schema into a relocatable image, which can be
+		// parsed against with args::schema_view.
+		LIBARGS_API std::string freeze() const;
 
 		LIBARGS_API void printer_append_usage(std::string& out) const;
 		LIBARGS_API fmt_list printer_arguments() const;
@@ -228,4 +388,44 @@ namespace args {
 		    std::string const& msg,
 		    std::optional<size_t> maybe_width = {}) const;
 	};
+
+	// Base for the lookups, which scan the arguments of a parser: answer
+	// files are opened and closed the way parser::parse() does it.
+	class LIBARGS_API answer_files_lookup : public schema_lookup {
+	public:
+		explicit answer_files_lookup(parser& p) noexcept : parser_{p} {}
+
+		char answer_file_marker() override;
+		std::vector<std::string_view> const& open_answer_file(
+		    std::string_view path) override;
+		void close_answer_file() override;
+
+	protected:
+		~answer_files_lookup() = default;
+
+		parser& parser_;
+	};
+
+	namespace detail {
+		template <typename Storage>
+		void attach_registered(parser& p,
+		                       Storage& dst,
+		                       std::string_view name,
+		                       char short_name,
+		                       std::string_view help) {
+			auto const add = [&](auto&&... names) {
+				if constexpr (std::is_same_v<Storage, bool>)
+					return p.set<std::true_type>(dst, names...);
+				else
+					return p.arg(dst, names...);
+			};
+
+			// the registrations are constant-initialised, they outlive the
+			// parser
+			auto builder = short_name ? add(std::string(1, short_name),
+			                                literal{name})
+			                          : add(literal{name});
+			builder.help(literal{help}).opt();
+		}
+	}  // namespace detail
 }  // namespace args
@@ -0,0 +1,131 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/api.hpp>
+#include <cstddef>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace args {
+	struct arity {
+		static constexpr unsigned unbounded =
+		    std::numeric_limits<unsigned>::max();
+
+		unsigned min{1};
+		unsigned max{1};
+	};
+
+	namespace nargs {
+		inline constexpr arity optional{0, 1};                  // "?"
+		inline constexpr arity any{0, arity::unbounded};        // "*"
+		inline constexpr arity one_or_more{1, arity::unbounded};  // "+"
+		constexpr arity exactly(unsigned count) noexcept {
+			return {count, count};
+		}
+	}  // namespace nargs
+
+	// Distributes positional values between the positional slots. Values,
+	// which would be needed by slots further down the plan are held back,
+	// until it is known they are not needed by the current slot; the number
+	// of held values is bounded by the sum of minimal arities of the
+	// remaining slots. Values are anything, which can be copied around
+	// cheaply: a view, or a view together with its origin.
+	template <typename Value = std::string_view>
+	class positional_cursor {
+	public:
+		struct slot {
+			size_t action{};
+			arity nargs{};
+			unsigned count{};
+		};
+
+		void plan(std::vector<slot> slots) {
+			slots_ = std::move(slots);
+			compute_reserve();
+			current_ = 0;
+			held_.clear();
+			held_front_ = 0;
+		}
+
+		// Adds slots after the planned ones; the values already delivered
+		// and the values held back stay where they are.
+		void extend(std::vector<slot> const& slots) {
+			slots_.insert(slots_.end(), slots.begin(), slots.end());
+			compute_reserve();
+		}
+
+		std::vector<slot> const& slots() const noexcept { return slots_; }
+		Value const& rejected() const noexcept { return rejected_; }
+
+		// Returns false, if there is no slot left for the value; the value
+		// is then available through rejected().
+		template <typename Deliver>
+		bool push(Value const& value, Deliver&& deliver) {
+			held_.push_back(value);
+			return drain(false, deliver);
+		}
+
+		// Hands the values still held back to the slots further down.
+		template <typename Deliver>
+		bool finish(Deliver&& deliver) {
+			return drain(true, deliver);
+		}
+
+	private:
+		void compute_reserve() {
+			reserve_.assign(slots_.size(), 0);
+			size_t reserve{};
+			for (auto index = slots_.size(); index > 0; --index) {
+				reserve_[index - 1] = reserve;
+				reserve += slots_[index - 1].nargs.min;
+			}
+		}
+
+		template <typename Deliver>
+		bool drain(bool final, Deliver& deliver) {
+			while (held_front_ < held_.size()) {
+				if (current_ >= slots_.size()) {
+					rejected_ = held_[held_front_];
+					held_.clear();
+					held_front_ = 0;
+					return false;
+				}
+
+				auto& slot = slots_[current_];
+				if (slot.count >= slot.nargs.max) {
+					++current_;
+					continue;
+				}
+
+				auto const held = held_.size() - held_front_;
+				if (slot.count < slot.nargs.min || held > reserve_[current_]) {
+					++slot.count;
+					deliver(slot.action, held_[held_front_++]);
+					continue;
+				}
+
+				if (!final) break;
+				++current_;
+			}
+
+			// compact, once the delivered prefix outgrows the held values
+			if (held_front_ * 2 >= held_.size()) {
+				held_.erase(held_.begin(),
+				            held_.begin() +
+				                static_cast<std::ptrdiff_t>(held_front_));
+				held_front_ = 0;
+			}
+			return true;
+		}
+
+		std::vector<slot> slots_{};
+		std::vector<size_t> reserve_{};
+		std::vector<Value> held_{};
+		size_t held_front_{};
+		size_t current_{};
+		Value rejected_{};
+	};
+}  // namespace args
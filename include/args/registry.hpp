@@ -0,0 +1,132 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace args {
+	class parser;
+
+	// Option defined away from main(), in any translation unit linked into
+	// the program. The description is constant-initialised; the action is
+	// only added to a parser, when the option is used.
+	struct registered_option {
+		std::string_view long_name{};
+		char short_name{};
+		void (*attach)(parser&){};
+	};
+
+	class option_registry {
+	public:
+		static constexpr size_t npos = static_cast<size_t>(-1);
+		using pointer = registered_option const* const*;
+
+		constexpr option_registry() = default;
+		constexpr option_registry(pointer first, pointer last) noexcept
+		    : first_{first}, last_{last} {}
+
+		constexpr size_t size() const noexcept {
+			return static_cast<size_t>(last_ - first_);
+		}
+		// can be null, for the padding some linkers add to the sections
+		constexpr registered_option const* operator[](
+		    size_t index) const noexcept {
+			return first_[index];
+		}
+
+		constexpr size_t find(std::string_view name) const noexcept {
+			for (size_t index = 0; index < size(); ++index) {
+				auto const option = first_[index];
+				if (option && option->long_name == name) return index;
+			}
+			return npos;
+		}
+
+		constexpr size_t find(char name) const noexcept {
+			for (size_t index = 0; index < size(); ++index) {
+				auto const option = first_[index];
+				if (option && option->short_name == name) return index;
+			}
+			return npos;
+		}
+
+	private:
+		pointer first_{};
+		pointer last_{};
+	};
+}  // namespace args
+
+// The pointers to the option descriptions are gathered by the linker in a
+// single section, so there is nothing to run before main(). The bounds of
+// the section are read in the module, which includes this header.
+#if defined(_MSC_VER)
+// Not supported: the linker keeps a section entry only, when the entry is
+// referenced by name (/include), and these are statics without one.
+#define LIBARGS_REGISTRY_UNSUPPORTED
+
+namespace args {
+	inline option_registry linked_options() noexcept { return {}; }
+}  // namespace args
+#elif defined(__APPLE__)
+#define LIBARGS_REGISTRY_ENTRY \
+	__attribute__((used, section("__DATA,argsopt")))
+
+extern args::registered_option const* const __args_registry_first[] __asm(
+    "section$start$__DATA$argsopt");
+extern args::registered_option const* const __args_registry_last[] __asm(
+    "section$end$__DATA$argsopt");
+
+namespace args {
+	inline option_registry linked_options() noexcept {
+		return {__args_registry_first, __args_registry_last};
+	}
+}  // namespace args
+#else
+#define LIBARGS_REGISTRY_ENTRY __attribute__((used, section("args_options")))
+
+// weak, so that a program without any registered option still links
+extern "C" {
+extern args::registered_option const* const __start_args_options[]
+    __attribute__((weak));
+extern args::registered_option const* const __stop_args_options[]
+    __attribute__((weak));
+}
+
+namespace args {
+	inline option_registry linked_options() noexcept {
+		return {__start_args_options, __stop_args_options};
+	}
+}  // namespace args
+#endif
+
+#define LIBARGS_REGISTRY_CAT2(A, B) A##B
+#define LIBARGS_REGISTRY_CAT(A, B) LIBARGS_REGISTRY_CAT2(A, B)
+
+// Two registrations on one line, e.g. from one macro, still need two names.
+#if defined(__COUNTER__)
+#define LIBARGS_REGISTRY_ID __COUNTER__
+#else
+#define LIBARGS_REGISTRY_ID __LINE__
+#endif
+
+#if defined(LIBARGS_REGISTRY_UNSUPPORTED)
+#define LIBARGS_REGISTER_OPTION_AS(ID, VAR, NAME, SHORT, HELP) \
+	static_assert(false, "ARGS_REGISTER_OPTION is not supported by MSVC")
+#else
+#define LIBARGS_REGISTER_OPTION_AS(ID, VAR, NAME, SHORT, HELP)             \
+	static constexpr ::args::registered_option LIBARGS_REGISTRY_CAT(       \
+	    args_registered_, ID){                                             \
+	    NAME, SHORT, [](::args::parser& p) {                               \
+		    ::args::detail::attach_registered(p, VAR, NAME, SHORT, HELP); \
+	    }};                                                                \
+	LIBARGS_REGISTRY_ENTRY static ::args::registered_option const* const  \
+	    LIBARGS_REGISTRY_CAT(args_registered_ptr_, ID) =                  \
+	        &LIBARGS_REGISTRY_CAT(args_registered_, ID)
+#endif
+
+// Registers a global variable as an optional argument; NAME is the long
+// name, SHORT a single character, or 0.
+#define ARGS_REGISTER_OPTION(VAR, NAME, SHORT, HELP) \
+	LIBARGS_REGISTER_OPTION_AS(LIBARGS_REGISTRY_ID, VAR, NAME, SHORT, HELP)
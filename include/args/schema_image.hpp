@@ -0,0 +1,246 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/parser.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace args {
+	// Read-only view on the schema frozen by parser::freeze(). The image
+	// keeps flags, names, metas and help texts of all the actions together
+	// with the lookup tables, using offsets in place of pointers, so it can
+	// be embedded in a binary or mapped by many processes at once. Nothing
+	// is built, when the view is created; the image must outlive the view.
+	class schema_view {
+	public:
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		using event = scan_event;
+
+		// Broken rule found by scanner::violations(), named after the
+		// message the parser would print for it.
+		struct violation {
+			enum kind_type {
+				required,
+				needs_params,
+				not_allowed_with,
+				one_of_required,
+				requires_argument
+			};
+
+			kind_type kind{required};
+			// the argument breaking the rule; npos for one_of_required
+			size_t action{npos};
+			// the argument it conflicts with, or depends on
+			size_t other{npos};
+			// position of the constraint, for the last three kinds
+			size_t rule{npos};
+		};
+
+		// Scans the arguments against the image; errors are reported as
+		// events, the caller decides what to do with them.
+		class scanner {
+		public:
+			LIBARGS_API bool next(event& ev);
+			// All the rules broken by the arguments seen so far, in the
+			// order parser::validate() would report them.
+			LIBARGS_API std::vector<violation> violations() const;
+			// See event_stream::rest().
+			arglist rest() const noexcept { return scanner_.rest(); }
+
+		private:
+			friend class schema_view;
+			class lookup;
+			scanner(schema_view const& schema, arglist const& args);
+
+			schema_view const* schema_;
+			arg_scanner scanner_;
+			positional_cursor<arg_token> positionals_{};
+			bitset seen_{};
+		};
+
+		// Reason for rejecting an image; every offset, length and action
+		// index in it is checked, when the view is created.
+		enum class image_error {
+			none,
+			not_an_image,
+			// frozen on a machine with the other byte order
+			byte_order,
+			// frozen by another version of the library
+			version,
+			// truncated, or longer than its header says
+			size,
+			// an offset, a length or an action index out of bounds
+			out_of_range
+		};
+
+		schema_view() = default;
+		LIBARGS_API explicit schema_view(std::string_view image) noexcept;
+
+		// false for an image rejected by the constructor; error() tells,
+		// why it was
+		bool valid() const noexcept { return !image_.empty(); }
+		image_error error() const noexcept { return error_; }
+
+		size_t size() const noexcept { return word(field_actions); }
+		bool provides_help() const noexcept {
+			return word(field_flags) & help_flag;
+		}
+		bool stops_at_positional() const noexcept {
+			return word(field_flags) & stop_flag;
+		}
+
+		LIBARGS_API size_t find(std::string_view name) const noexcept;
+		LIBARGS_API size_t find(char name) const noexcept;
+
+		bool needs_arg(size_t action) const noexcept {
+			return flags(action) & needs_arg_flag;
+		}
+		bool required(size_t action) const noexcept {
+			return flags(action) & required_flag;
+		}
+		bool multiple(size_t action) const noexcept {
+			return flags(action) & multiple_flag;
+		}
+		bool positional(size_t action) const noexcept {
+			return flags(action) & positional_flag;
+		}
+		arity nargs(size_t action) const noexcept {
+			return {field(action, action_min), field(action, action_max)};
+		}
+
+		size_t constraint_count() const noexcept {
+			return word(field_constraints);
+		}
+		constraint::kind_type constraint_kind(size_t rule) const noexcept {
+			return static_cast<constraint::kind_type>(
+			    rule_word(rule, rule_kind));
+		}
+		bool constraint_member(size_t rule, size_t action) const noexcept {
+			return (rule_word(rule, rule_members + action / 32) >>
+			        (action % 32)) &
+			       1u;
+		}
+
+		size_t name_count(size_t action) const noexcept {
+			return field(action, action_name_count);
+		}
+		LIBARGS_API std::string_view name(size_t action,
+		                                  size_t index = 0) const noexcept;
+		std::string_view meta(size_t action) const noexcept {
+			return pool_text(field(action, action_meta),
+			                 field(action, action_meta_length));
+		}
+		std::string_view help(size_t action) const noexcept {
+			return pool_text(field(action, action_help),
+			                 field(action, action_help_length));
+		}
+
+		scanner scan(arglist const& args) const { return {*this, args}; }
+
+		// layout of the image, in 32-bit words
+		enum header_field : size_t {
+			field_magic,
+			field_byte_order,
+			field_version,
+			field_actions,
+			field_names,
+			field_long_names,
+			field_positionals,
+			field_constraints,
+			field_flags,
+			field_pool,
+			header_size
+		};
+		enum action_field : size_t {
+			action_flags,
+			action_first_name,
+			action_name_count,
+			action_meta,
+			action_meta_length,
+			action_help,
+			action_help_length,
+			action_min,
+			action_max,
+			action_size
+		};
+		enum rule_field : size_t {
+			rule_kind,
+			rule_dependent,
+			rule_dependee,
+			rule_members
+		};
+		enum flag : std::uint32_t {
+			needs_arg_flag = 1,
+			required_flag = 2,
+			multiple_flag = 4,
+			positional_flag = 8
+		};
+		static constexpr std::uint32_t help_flag = 1;
+		static constexpr std::uint32_t stop_flag = 2;
+		static constexpr std::uint32_t magic = 0x53475241;  // "ARGS"
+		// written in the byte order of the machine freezing the image
+		static constexpr std::uint32_t byte_order = 0x01020304;
+		static constexpr std::uint32_t version = 3;
+		static constexpr size_t short_names_size = 256;
+		static constexpr size_t name_size = 2;
+		static constexpr size_t long_name_size = 3;
+
+	private:
+		image_error check() const noexcept;
+
+		// the image does not have to be aligned; words past its end, asked
+		// for with an action index out of range, read as zero
+		std::uint32_t word(size_t index) const noexcept {
+			std::uint32_t result{};
+			if (index >= image_.size() / sizeof(result)) return 0;
+			std::memcpy(&result, image_.data() + index * sizeof(result),
+			            sizeof(result));
+			return result;
+		}
+		size_t short_names() const noexcept { return header_size; }
+		size_t actions() const noexcept {
+			return short_names() + short_names_size;
+		}
+		size_t names() const noexcept {
+			return actions() + word(field_actions) * action_size;
+		}
+		size_t long_names() const noexcept {
+			return names() + word(field_names) * name_size;
+		}
+		size_t positionals() const noexcept {
+			return long_names() + word(field_long_names) * long_name_size;
+		}
+		size_t constraints() const noexcept {
+			return positionals() + word(field_positionals);
+		}
+		size_t constraint_size() const noexcept {
+			return rule_members + (word(field_actions) + 31) / 32;
+		}
+		size_t pool() const noexcept {
+			return constraints() + word(field_constraints) * constraint_size();
+		}
+		std::uint32_t rule_word(size_t rule, size_t index) const noexcept {
+			return word(constraints() + rule * constraint_size() + index);
+		}
+		std::uint32_t field(size_t action, action_field id) const noexcept {
+			return word(actions() + action * action_size + id);
+		}
+		std::uint32_t flags(size_t action) const noexcept {
+			return field(action, action_flags);
+		}
+		std::string_view pool_text(std::uint32_t offset,
+		                           std::uint32_t length) const noexcept {
+			auto const start = pool() * sizeof(std::uint32_t) + offset;
+			if (start > image_.size()) return {};
+			return image_.substr(start, length);
+		}
+
+		std::string_view image_{};
+		image_error error_{image_error::not_an_image};
+	};
+}  // namespace args
@@ -0,0 +1,23 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+// No include guard: each file using the lists includes this header right
+// before the use and #undefs both macros afterwards, so they do not leak
+// into the code including the library headers.
+
+// Storage types, for which the library carries explicit instantiations of
+// the actions and converters. Any other type is instantiated on demand, as
+// before.
+#define LIBARGS_FOR_EACH_INTEGER(X) \
+	X(short)                        \
+	X(unsigned short)               \
+	X(int)                          \
+	X(unsigned)                     \
+	X(long)                         \
+	X(unsigned long)                \
+	X(long long)                    \
+	X(unsigned long long)
+
+#define LIBARGS_FOR_EACH_STORAGE(X) \
+	X(std::string)                  \
+	LIBARGS_FOR_EACH_INTEGER(X)
@@ -0,0 +1,52 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/parser.hpp>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+
+namespace args {
+	// Git-style commands: the first positional argument selects the
+	// command, the rest of the arguments belong to the parser of that
+	// command. Only the parser of the selected command is ever created;
+	// options shared by all the levels are defined by a common schema,
+	// applied to each parser on the way.
+	class subcommands {
+	public:
+		// Defines the options of the command on its parser, parses the
+		// arguments and runs the command.
+		using factory = std::function<int(parser&)>;
+		using schema = std::function<void(parser&)>;
+
+		// The name and the help are copied, unless given as args::literal.
+		struct command {
+			text name{};
+			text help{};
+			factory run{};
+		};
+
+		subcommands() = default;
+		LIBARGS_API subcommands(std::initializer_list<command> commands);
+
+		LIBARGS_API void add(command cmd);
+		void common(schema define) { common_ = std::move(define); }
+
+		LIBARGS_API command const* find(std::string_view name) const;
+
+		// Parses the arguments of the current level and runs the command
+		// named by the first positional argument.
+		LIBARGS_API int run(parser& p, std::optional<size_t> maybe_width = {});
+
+	private:
+		std::vector<command> commands_{};
+		std::unordered_map<std::string, size_t> index_{};
+		schema common_{};
+		// parser of the command being run, which already has the common
+		// options, in case its factory runs the same commands again
+		parser const* prepared_{};
+	};
+}  // namespace args
@@ -23,7 +23,19 @@ namespace args {
 		needed_enum_known_values,
 		required,
 		error_msg,
-		file_not_found
+		file_not_found,
+		not_allowed_with,
+		one_of_required,
+		requires_argument,
+		answer_file_cycle,
+		answer_file_too_deep,
+		needs_params,
+		commands,
+		command_meta,
+		unknown_command,
+		undefined_argument,
+		single_value_nargs,
+		answer_file_separator
 	};
 
 	struct LIBARGS_API base_translator {
@@ -0,0 +1,72 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/action_table.hpp>
+#include "dispatch.hpp"
+
+void args::action_table::sync(
+    std::vector<std::unique_ptr<actions::action>> const& actions) {
+	auto const known = size();
+	auto const count = actions.size();
+
+	needs_arg.resize(count);
+	required.resize(count);
+	multiple.resize(count);
+	positional.resize(count);
+	user.resize(count);
+	first_names_.reserve(count);
+
+	size_t pool_size = pool_.size();
+	size_t long_count = long_names_.size();
+	for (auto index = known; index < count; ++index) {
+		for (auto const& name : dispatch::names(*actions[index])) {
+			pool_size += name.length();
+			if (name.length() > 1) ++long_count;
+		}
+	}
+	pool_.reserve(pool_size);
+	long_names_.reserve(long_count);
+
+	for (auto index = known; index < count; ++index) {
+		auto const& names = dispatch::names(*actions[index]);
+		auto const action = static_cast<std::uint32_t>(index);
+		auto const is_user =
+		    actions[index]->kind() == actions::action_kind::user;
+
+		positional.set(index, names.empty());
+		user.set(index, is_user);
+		if (names.empty()) {
+			first_names_.push_back({0, 0, action});
+			continue;
+		}
+
+		bool first = true;
+		for (auto const& name : names) {
+			name_ref const ref{static_cast<std::uint32_t>(pool_.size()),
+			                   static_cast<std::uint32_t>(name.length()),
+			                   action};
+			pool_.append(name);
+
+			if (first) {
+				first = false;
+				first_names_.push_back(ref);
+			}
+			if (is_user) continue;
+
+			if (name.length() == 1) {
+				// first action with the name wins, as it did with the scans
+				auto& slot = short_names_[static_cast<unsigned char>(name[0])];
+				if (!slot) slot = action + 1;
+			} else if (name.length() > 1) {
+				long_names_.push_back(ref);
+			}
+		}
+	}
+
+	for (size_t index = 0; index < count; ++index) {
+		auto const& action = *actions[index];
+		needs_arg.set(index, dispatch::needs_arg(action));
+		required.set(index, dispatch::required(action));
+		multiple.set(index, dispatch::multiple(action));
+	}
+}
@@ -4,18 +4,34 @@
 #include <args/actions.hpp>
 #include <args/parser.hpp>
 #include <args/translator.hpp>
+#include "dispatch.hpp"
 
 args::actions::action::~action() = default;
 args::actions::action::action() = default;
 args::actions::action::action(action&&) = default;
 args::actions::action& args::actions::action::operator=(action&&) = default;
 
+void args::actions::action::visit_view(parser& p, std::string_view arg) {
+	visit(p, materialize(p, arg));
+}
+
+void args::actions::action::check(parser&, std::string_view) {}
+
+void args::actions::action::nargs(arity) {}
+
+void args::actions::action::reset() {}
+
+args::arity args::actions::action::nargs() const {
+	return {required() ? 1u : 0u, multiple() ? arity::unbounded : 1u};
+}
+
 void args::actions::action::append_short_help(base_translator const& _,
                                               std::string& s) const {
-	auto aname = ([this](base_translator const& _) {
-		if (names().empty()) return meta(_);
+	auto const names = dispatch::names(*this);
+	auto aname = ([&, this](base_translator const& _) {
+		if (names.empty()) return meta(_);
 
-		auto const& name = names().front();
+		auto const name = names.front();
 		size_t const length = name.length();
 		size_t additional = 0;
 		if (length > 1) ++additional;
@@ -34,6 +50,17 @@ void args::actions::action::append_short_help(base_translator const& _,
 		return aname;
 	}(_));
 
+	if (names.empty()) {
+		auto const values = nargs();
+		if (values.min > 1 && values.min == values.max) {
+			for (unsigned count = 0; count < values.min; ++count) {
+				s.push_back(' ');
+				s.append(aname);
+			}
+			return;
+		}
+	}
+
 	int flags = (required() ? 2 : 0) | (multiple() ? 1 : 0);
 
 	if (flags & 2) {
@@ -56,10 +83,11 @@ void args::actions::action::append_short_help(base_translator const& _,
 
 std::string args::actions::action::help_name(base_translator const& _) const {
 	auto meta_value = meta(_);
+	auto const names = dispatch::names(*this);
 
 	size_t length = 0;
 	bool first = true;
-	for (auto& name : names()) {
+	for (auto name : names) {
 		if (first)
 			first = false;
 		else
@@ -78,7 +106,7 @@ std::string args::actions::action::help_name(base_translator const& _) const {
 	nmz.reserve(length);
 
 	first = true;
-	for (auto& name : names()) {
+	for (auto name : names) {
 		if (first)
 			first = false;
 		else
@@ -100,25 +128,90 @@ std::string args::actions::action::help_name(base_translator const& _) const {
 }
 
 std::string args::actions::action_base::meta(base_translator const& _) const {
-	return meta_.empty() ? _(lng::def_meta) : meta_;
+	return meta_.empty() ? _(lng::def_meta) : std::string{meta_.view()};
+}
+
+std::string const& args::actions::action_base::argname(parser& p) const {
+	// computed once per action, so that long names do not cost an allocation
+	// on every value
+	if (!argname_.empty()) return argname_;
+
+	if (names_.empty()) {
+		argname_ = meta(p.tr());
+		return argname_;
+	}
+
+	auto const name = names_.front();
+	argname_ = name.length() > 1 ? "--" : "-";
+	argname_.append(name);
+	return argname_;
+}
+
+args::actions::builder& args::actions::builder::meta(text name) {
+	dispatch::meta(*ptr, std::move(name));
+	return *this;
+}
+
+args::actions::builder& args::actions::builder::help(text dscr) {
+	dispatch::help(*ptr, std::move(dscr));
+	return *this;
+}
+
+args::actions::builder& args::actions::builder::nargs(arity value) {
+	ptr->nargs(value);
+	ptr->required(value.min > 0);
+	ptr->multiple(value.max > 1);
+	if (ptr->nargs().max >= value.max) return *this;
+
+	auto& p = *owner;
+	auto const names = dispatch::names(*ptr);
+	std::string name{};
+	if (names.empty()) {
+		name = ptr->meta(p.tr());
+	} else {
+		auto const front = names.front();
+		name = front.length() > 1 ? "--" : "-";
+		name.append(front);
+	}
+	p.attach_registered();
+	p.error(p.tr()(lng::single_value_nargs, name), p.parse_width());
+}
+
+args::actions::deferred::~deferred() = default;
+
+bool args::actions::converts_in_bulk(parser& p) noexcept {
+	return static_cast<bool>(p.executor());
+}
+
+void args::actions::defer(parser& p, deferred& values) {
+	p.deferred_.push_back(&values);
+}
+
+args::parse_stats& args::actions::stats(parser& p) noexcept {
+	return p.stats();
+}
+
+std::string_view args::actions::keep(parser& p, std::string_view value) {
+	return p.keep(value);
 }
 
-std::string args::actions::action_base::argname(parser& p) const {
-	if (names().empty()) return meta(p.tr());
-	auto& name = names().front();
-	if (name.length() > 1) return "--" + name;
-	return "-" + name;
+char const* args::actions::null_terminated(parser& p, std::string_view value) {
+	// answer files are null-terminated in place, only the arguments may not be
+	if (p.args().terminated()) return value.data();
+	return p.keep(value).data();
 }
 
 [[noreturn]] void args::actions::argument_is_not_integer(
     parser& p,
     std::string const& name) {
+	p.attach_registered();
 	p.error(p.tr()(lng::needs_number, name), p.parse_width());
 }
 
 [[noreturn]] void args::actions::argument_out_of_range(
     parser& p,
     std::string const& name) {
+	p.attach_registered();
 	p.error(p.tr()(lng::needed_number_exceeded, name), p.parse_width());
 }
 
@@ -127,7 +220,30 @@ std::string args::actions::action_base::argname(parser& p) const {
     std::string const& name,
     std::string const& value,
     std::string const& values) {
+	p.attach_registered();
 	p.error(p.tr()(lng::needed_enum_unknown, name, value) + "\n" +
 	            p.tr()(lng::needed_enum_known_values, name, values),
 	        p.parse_width());
 }
+
+#include <args/storage_types.hpp>
+
+namespace args {
+#define LIBARGS_INSTANTIATE_CONVERTER(TYPE) \
+	template struct from_chars_converter<TYPE>;
+#define LIBARGS_INSTANTIATE_STORAGE(TYPE)                            \
+	template struct converter<TYPE>;                                 \
+	template struct converter<std::optional<TYPE>>;                  \
+	template class LIBARGS_API actions::store_action<TYPE>;          \
+	template class LIBARGS_API                                       \
+	    actions::store_action<std::optional<TYPE>>;                  \
+	template class LIBARGS_API actions::store_action<std::vector<TYPE>>;
+
+	LIBARGS_FOR_EACH_INTEGER(LIBARGS_INSTANTIATE_CONVERTER)
+	LIBARGS_FOR_EACH_STORAGE(LIBARGS_INSTANTIATE_STORAGE)
+
+#undef LIBARGS_INSTANTIATE_CONVERTER
+#undef LIBARGS_INSTANTIATE_STORAGE
+#undef LIBARGS_FOR_EACH_STORAGE
+#undef LIBARGS_FOR_EACH_INTEGER
+}  // namespace args
@@ -0,0 +1,174 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/answer_file.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+	enum char_class : unsigned char { plain, space, special };
+
+	constexpr std::array<unsigned char, 256> make_classes() {
+		std::array<unsigned char, 256> classes{};
+		for (auto c : {' ', '\t', '\n', '\v', '\f', '\r'})
+			classes[static_cast<unsigned char>(c)] = space;
+		for (auto c : {'"', '\'', '\\'})
+			classes[static_cast<unsigned char>(c)] = special;
+		return classes;
+	}
+
+	constexpr auto classes = make_classes();
+
+	inline unsigned char class_of(char c) noexcept {
+		return classes[static_cast<unsigned char>(c)];
+	}
+
+	// The scan for the structural characters goes through the text eight
+	// bytes at a time, using plain 64-bit words in place of SIMD registers.
+	using word = std::uint64_t;
+	constexpr word ones = ~word{0} / 255;
+	constexpr word highs = ones * 0x80;
+
+	constexpr word has_less(word value, unsigned char limit) noexcept {
+		return (value - ones * limit) & ~value & highs;
+	}
+
+	constexpr word has_byte(word value, char byte) noexcept {
+		return has_less(value ^ (ones * static_cast<unsigned char>(byte)), 1);
+	}
+
+	inline bool maybe_structural(char const* text) noexcept {
+		word value{};
+		std::memcpy(&value, text, sizeof(value));
+		// all the whitespace, but the space itself, is below 0x0E; other
+		// control characters are weeded out by the byte loop
+		return has_less(value, 0x0E) | has_byte(value, ' ') |
+		       has_byte(value, '"') | has_byte(value, '\'') |
+		       has_byte(value, '\\');
+	}
+
+	size_t find_structural(char const* text, size_t pos, size_t length) {
+		while (true) {
+			while (pos + sizeof(word) <= length &&
+			       !maybe_structural(text + pos))
+				pos += sizeof(word);
+
+			auto const stop = std::min(pos + sizeof(word), length);
+			for (; pos < stop; ++pos) {
+				if (class_of(text[pos]) != plain) return pos;
+			}
+			if (pos == length) return pos;
+		}
+	}
+
+	void split_lines(char* text,
+	                 size_t length,
+	                 std::vector<std::string_view>& tokens) {
+		size_t pos{};
+		while (pos < length) {
+			auto const found = static_cast<char const*>(
+			    std::memchr(text + pos, '\n', length - pos));
+			auto const eol = found ? static_cast<size_t>(found - text) : length;
+			text[eol] = 0;
+
+			for (auto index = pos; index < eol; ++index) {
+				if (class_of(text[index]) != space) {
+					tokens.emplace_back(text + pos, eol - pos);
+					break;
+				}
+			}
+
+			pos = eol + 1;
+		}
+	}
+
+	// Unescaped text is never longer than the escaped one, so the tokens
+	// are unescaped in place; only the tokens after the first quote or
+	// backslash in the file need to be moved.
+	void split_tokens(char* text,
+	                  size_t length,
+	                  std::vector<std::string_view>& tokens) {
+		size_t pos{};
+		while (pos < length) {
+			if (class_of(text[pos]) == space) {
+				++pos;
+				continue;
+			}
+
+			if (text[pos] == '#') {
+				auto const found = static_cast<char const*>(
+				    std::memchr(text + pos, '\n', length - pos));
+				pos = found ? static_cast<size_t>(found - text) + 1 : length;
+				continue;
+			}
+
+			auto const start = pos;
+			auto out = pos;
+			while (pos < length) {
+				auto const next = find_structural(text, pos, length);
+				if (out != pos) std::memmove(text + out, text + pos, next - pos);
+				out += next - pos;
+				pos = next;
+
+				if (pos == length || class_of(text[pos]) == space) break;
+
+				auto const quote = text[pos++];
+				if (quote == '\\') {
+					if (pos < length) text[out++] = text[pos++];
+					continue;
+				}
+
+				// single quotes keep everything as-is, double quotes still
+				// allow the backslash escapes
+				while (pos < length && text[pos] != quote) {
+					if (quote == '"' && text[pos] == '\\' && pos + 1 < length)
+						++pos;
+					text[out++] = text[pos++];
+				}
+				if (pos < length) ++pos;
+			}
+
+			text[out] = 0;
+			tokens.emplace_back(text + start, out - start);
+			if (pos < length) ++pos;
+		}
+	}
+}  // namespace
+
+bool args::answer_file_contents::read(std::string const& path,
+                                      answer_dialect dialect) {
+	std::ifstream file{path};
+	if (file.fail()) return false;
+
+	file.seekg(0, std::ios::end);
+	auto const size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (size < 0) return false;
+
+	text = std::make_unique<char[]>(static_cast<size_t>(size) + 1);
+	file.read(text.get(), static_cast<std::streamsize>(size));
+	// with text mode line endings, less than size could have been read
+	split(static_cast<size_t>(file.gcount()), dialect);
+	return true;
+}
+
+void args::answer_file_contents::assign(std::string_view contents,
+                                        answer_dialect dialect) {
+	text = std::make_unique<char[]>(contents.length() + 1);
+	std::memcpy(text.get(), contents.data(), contents.length());
+	split(contents.length(), dialect);
+}
+
+void args::answer_file_contents::split(size_t length,
+                                       answer_dialect dialect) {
+	tokens.clear();
+	text[length] = 0;
+	if (dialect == answer_dialect::tokens)
+		split_tokens(text.get(), length, tokens);
+	else
+		split_lines(text.get(), length, tokens);
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/parser.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+	// below this many values per task, handing the work over costs more,
+	// than it saves
+	constexpr size_t min_chunk = 16384;
+
+	template <typename Storage>
+	args::number_error convert_one(std::string_view raw, Storage& out) {
+		if constexpr (std::is_same_v<Storage, std::string>) {
+			out.assign(raw.data(), raw.length());
+			return args::number_error::none;
+		} else {
+			return args::from_chars_converter<Storage>::convert(raw, out);
+		}
+	}
+
+	template <typename Storage>
+	void convert_all(args::parser& p,
+	                 std::vector<std::string_view> const& raw,
+	                 std::vector<Storage>& out,
+	                 std::string const& name) {
+		LIBARGS_STAGE(args::actions::stats(p), args::stage::conversion);
+		if constexpr (args::instrumentation::enabled)
+			args::actions::stats(p).conversions += raw.size();
+
+		auto const count = raw.size();
+		auto const offset = out.size();
+		out.resize(offset + count);
+
+		auto const& executor = p.executor();
+		auto const tasks =
+		    executor ? std::max(size_t{1}, count / min_chunk) : size_t{1};
+		auto const chunk = (count + tasks - 1) / tasks;
+
+		// index of the first value known to fail; the tasks stop, when they
+		// get past it, as the values after it would not be reported anyway
+		std::atomic<size_t> first_error{count};
+		auto const convert_chunk = [&](size_t task) {
+			auto const end = std::min(count, (task + 1) * chunk);
+			for (auto index = task * chunk; index < end; ++index) {
+				if (index > first_error.load(std::memory_order_relaxed))
+					return;
+				if (convert_one(raw[index], out[offset + index]) ==
+				    args::number_error::none)
+					continue;
+
+				auto known = first_error.load(std::memory_order_relaxed);
+				while (index < known &&
+				       !first_error.compare_exchange_weak(known, index)) {
+				}
+				return;
+			}
+		};
+
+		if (tasks > 1)
+			executor(tasks, convert_chunk);
+		else
+			convert_chunk(0);
+
+		auto const index = first_error.load();
+		if (index == count) return;
+
+		Storage ignored{};
+		auto const error = convert_one(raw[index], ignored);
+		if (error == args::number_error::out_of_range)
+			args::actions::argument_out_of_range(p, name);
+		args::actions::argument_is_not_integer(p, name);
+	}
+}  // namespace
+
+#include <args/storage_types.hpp>
+
+#define LIBARGS_DEFINE_BULK(TYPE)                                          \
+	void args::detail::bulk_convert(                                       \
+	    parser& p, std::vector<std::string_view> const& raw,               \
+	    std::vector<TYPE>& out, std::string const& name) {                 \
+		convert_all(p, raw, out, name);                                    \
+	}
+
+LIBARGS_FOR_EACH_STORAGE(LIBARGS_DEFINE_BULK)
+
+#undef LIBARGS_DEFINE_BULK
+#undef LIBARGS_FOR_EACH_STORAGE
+#undef LIBARGS_FOR_EACH_INTEGER
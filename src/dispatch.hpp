@@ -0,0 +1,81 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/actions.hpp>
+
+// Static dispatch for the actions built into the library; the qualified
+// calls to action_base members skip the vtable and can be inlined. Only the
+// user actions pay for the virtual calls.
+namespace args::dispatch {
+	using actions::action;
+	using actions::action_base;
+	using actions::action_kind;
+
+	inline action_base const* builtin(action const& act) noexcept {
+		if (act.kind() == action_kind::user) return nullptr;
+		return static_cast<action_base const*>(&act);
+	}
+
+	inline bool needs_arg(action const& act) {
+		switch (act.kind()) {
+			case action_kind::store:
+			case action_kind::callback_with_value:
+				return true;
+			case action_kind::flag:
+			case action_kind::callback:
+				return false;
+			case action_kind::user:
+				break;
+		}
+		return act.needs_arg();
+	}
+
+	inline names_view names(action const& act) {
+		if (auto base = builtin(act)) return base->name_texts();
+		return act.names();
+	}
+
+	inline std::string_view help(action const& act) {
+		if (auto base = builtin(act)) return base->help_text();
+		return act.help();
+	}
+
+	// the built-in actions keep a literal without a copy
+	inline void meta(action& act, text value) {
+		if (act.kind() == action_kind::user)
+			act.meta(value.view());
+		else
+			static_cast<action_base&>(act).set_meta(std::move(value));
+	}
+
+	inline void help(action& act, text value) {
+		if (act.kind() == action_kind::user)
+			act.help(value.view());
+		else
+			static_cast<action_base&>(act).set_help(std::move(value));
+	}
+
+	// the user actions may match names in their own way
+	template <typename Name>
+	inline bool is(action const& act, Name name) {
+		if (auto base = builtin(act)) return base->action_base::is(name);
+		return act.is(name);
+	}
+
+	inline bool required(action const& act) {
+		if (auto base = builtin(act)) return base->action_base::required();
+		return act.required();
+	}
+
+	inline bool multiple(action const& act) {
+		if (auto base = builtin(act)) return base->action_base::multiple();
+		return act.multiple();
+	}
+
+	inline arity nargs(action const& act) {
+		if (auto base = builtin(act)) return base->action_base::nargs();
+		return act.nargs();
+	}
+}  // namespace args::dispatch
@@ -0,0 +1,396 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/parser.hpp>
+
+namespace args::detail {
+	// The actions of the parser, as seen by the scanner of an event_stream.
+	class action_lookup final : public answer_files_lookup {
+	public:
+		explicit action_lookup(parser& p) noexcept : answer_files_lookup{p} {}
+
+		size_t find(std::string_view name) override {
+			return parser_.lookup(name);
+		}
+		size_t find(char name) override { return parser_.lookup(name); }
+		bool needs_arg(size_t action) override {
+			return parser_.table_.needs_arg.test(action);
+		}
+		bool provides_help() override { return parser_.provide_help_; }
+		positional_cursor<arg_token>& positionals() override {
+			return parser_.positionals_;
+		}
+		bool stops_at_positional() override {
+			return parser_.stop_at_positional_;
+		}
+	};
+}  // namespace args::detail
+
+char args::answer_files_lookup::answer_file_marker() {
+	return parser_.uses_answer_file() ? parser_.answer_file_marker() : 0;
+}
+
+std::vector<std::string_view> const&
+args::answer_files_lookup::open_answer_file(std::string_view path) {
+	return parser_.open_answer_file(std::string{path}).tokens;
+}
+
+void args::answer_files_lookup::close_answer_file() {
+	parser_.close_answer_file();
+}
+
+bool args::schema_lookup::stops_at_positional() {
+	return false;
+}
+
+char args::schema_lookup::answer_file_marker() {
+	return 0;
+}
+
+std::vector<std::string_view> const& args::schema_lookup::open_answer_file(
+    std::string_view) {
+	static std::vector<std::string_view> const none{};
+	return none;
+}
+
+void args::schema_lookup::close_answer_file() {}
+
+args::arg_scanner::arg_scanner(arglist const& args) noexcept {
+	args_.tokens = args;
+}
+
+args::arg_scanner args::arg_scanner::single_file(
+    std::vector<std::string_view> const& tokens) noexcept {
+	arg_scanner scanner{};
+	scanner.args_.tokens = {tokens.data(), tokens.size()};
+	scanner.args_.source = event_source::answer_file;
+	scanner.single_file_ = true;
+	return scanner;
+}
+
+bool args::arg_scanner::next(schema_lookup& lookup, scan_event& event) {
+	stop_ = stop::none;
+	while (true) {
+		if (pending_front_ < pending_.size()) {
+			event = pending_[pending_front_++];
+			if (pending_front_ == pending_.size()) {
+				pending_.clear();
+				pending_front_ = 0;
+			}
+			// values rejected at the end of the arguments cannot be taken
+			// by any positional argument added later
+			if (event.kind == scan_event::unknown && !finished_)
+				stopped(stop::positional,
+				        {event.value, event.source, event.index});
+			return true;
+		}
+
+		if (finished_) return false;
+
+		if (!retry_.value.empty()) {
+			auto const token = retry_;
+			retry_ = {};
+			long_option(lookup, token, event);
+			return true;
+		}
+
+		if (!cluster_.value.empty()) {
+			short_option(lookup, event);
+			return true;
+		}
+
+		arg_token token{};
+		if (!next_token(lookup, token)) {
+			finish(lookup);
+			continue;
+		}
+
+		++tokens_;
+		auto const arg = token.value;
+		if (arg == "--") {
+			if (token.source == event_source::answer_file) {
+				event = {scan_event::misplaced_separator, schema_lookup::npos,
+				         {}, arg, token.index, token.source};
+				return true;
+			}
+			// the rest of the command line is left as it is
+			end_options(lookup, args_.index);
+			continue;
+		}
+
+		if (arg.length() > 1 && arg[0] == '-') {
+			if (arg.length() > 2 && arg[1] == '-') {
+				long_option(lookup, token, event);
+				return true;
+			}
+
+			cluster_ = token;
+			cluster_.value = arg.substr(1);
+			cluster_arg_ = arg;
+			continue;
+		}
+
+		auto const marker = lookup.answer_file_marker();
+		if (marker && arg.length() > 1 && arg[0] == marker) {
+			if (single_file_) continue;
+			frame file{};
+			file.tokens = lookup.open_answer_file(arg.substr(1));
+			file.source = event_source::answer_file;
+			files_.push_back(file);
+			continue;
+		}
+
+		if (!single_file_) positional(lookup, token);
+	}
+}
+
+bool args::arg_scanner::frame::next(arg_token& token) noexcept {
+	if (index == tokens.size()) return false;
+	token.source = source;
+	token.index = index;
+	token.value = tokens[static_cast<unsigned>(index)];
+	++index;
+	return true;
+}
+
+args::arglist args::arg_scanner::rest() const noexcept {
+	if (!options_ended_) return {};
+	return args_.tokens.shift(static_cast<unsigned>(rest_));
+}
+
+void args::arg_scanner::end_options(schema_lookup& lookup, size_t rest) {
+	options_ended_ = true;
+	rest_ = rest;
+	finish(lookup);
+}
+
+void args::arg_scanner::finish(schema_lookup& lookup) {
+	finished_ = true;
+	if (single_file_) return;
+	auto const deliver = [this](size_t action, arg_token const& held) {
+		push(scan_event::positional, action, held);
+	};
+	auto& positionals = lookup.positionals();
+	if (!positionals.finish(deliver))
+		push(scan_event::unknown, schema_lookup::npos, positionals.rejected());
+}
+
+bool args::arg_scanner::next_token(schema_lookup& lookup, arg_token& token) {
+	while (!files_.empty()) {
+		if (files_.back().next(token)) return true;
+		files_.pop_back();
+		lookup.close_answer_file();
+	}
+	return args_.next(token);
+}
+
+void args::arg_scanner::long_option(schema_lookup& lookup,
+                                    arg_token const& token,
+                                    scan_event& event) {
+	auto const name = token.value.substr(2);
+	auto const pos = name.find('=');
+	auto const name_has_value = pos != std::string_view::npos;
+	auto const used_name = name.substr(0, pos);
+
+	event = {scan_event::option, schema_lookup::npos, used_name, {},
+	         token.index, token.source};
+	if (lookup.provides_help() && name == "help") {
+		event.kind = scan_event::help;
+		return;
+	}
+
+	event.action_id = lookup.find(used_name);
+	if (event.action_id == schema_lookup::npos) {
+		event.kind = scan_event::unknown;
+		stopped(stop::long_option, token);
+		return;
+	}
+
+	if (!lookup.needs_arg(event.action_id)) {
+		if (name_has_value) event.kind = scan_event::unexpected_value;
+		return;
+	}
+
+	if (name_has_value) {
+		event.value = name.substr(pos + 1);
+		return;
+	}
+
+	arg_token value{};
+	if (!current().next(value)) {
+		event.kind = scan_event::missing_value;
+		return;
+	}
+
+	++tokens_;
+	event.value = value.value;
+}
+
+void args::arg_scanner::short_option(schema_lookup& lookup,
+                                     scan_event& event) {
+	auto const name = cluster_.value.substr(0, 1);
+	auto const rest = cluster_.value.substr(1);
+
+	event = {scan_event::option, schema_lookup::npos, name, {},
+	         cluster_.index, cluster_.source};
+	if (lookup.provides_help() && name[0] == 'h') {
+		event.kind = scan_event::help;
+		cluster_.value = rest;
+		return;
+	}
+
+	event.action_id = lookup.find(name[0]);
+	if (event.action_id == schema_lookup::npos) {
+		// the rest of the cluster, starting with the unknown name
+		event.kind = scan_event::unknown;
+		stopped(stop::short_option, cluster_);
+		cluster_.value = rest;
+		return;
+	}
+	cluster_.value = rest;
+
+	if (!lookup.needs_arg(event.action_id)) return;
+
+	// any argument with a value takes the rest of the cluster for itself
+	cluster_.value = {};
+	if (!rest.empty()) {
+		event.value = rest;
+		return;
+	}
+
+	arg_token value{};
+	if (!current().next(value)) {
+		event.kind = scan_event::missing_value;
+		return;
+	}
+
+	++tokens_;
+	event.value = value.value;
+}
+
+void args::arg_scanner::positional(schema_lookup& lookup,
+                                   arg_token const& token) {
+	auto const deliver = [this](size_t action, arg_token const& held) {
+		push(scan_event::positional, action, held);
+	};
+	auto& positionals = lookup.positionals();
+	if (positionals.push(token, deliver)) return;
+
+	auto const& rejected = positionals.rejected();
+	if (lookup.stops_at_positional() && !single_file_ &&
+	    rejected.source == event_source::arguments) {
+		end_options(lookup, rejected.index);
+		return;
+	}
+	push(scan_event::unknown, schema_lookup::npos, rejected);
+}
+
+void args::arg_scanner::push(scan_event::kind_type kind,
+                             size_t action,
+                             arg_token const& token) {
+	pending_.push_back(
+	    {kind, action, {}, token.value, token.index, token.source});
+}
+
+void args::arg_scanner::stopped(stop kind, arg_token const& token) {
+	stop_ = kind;
+	stopped_ = token;
+}
+
+args::unknown_arg args::arg_scanner::pass_through(scan_event const& event) {
+	switch (stop_) {
+		case stop::short_option:
+			cluster_.value = {};
+			return {cluster_arg_, stopped_.source, stopped_.index,
+			        static_cast<size_t>(stopped_.value.data() -
+			                            cluster_arg_.data())};
+		case stop::long_option:
+		case stop::positional:
+			return {stopped_.value, stopped_.source, stopped_.index, 0};
+		case stop::none:
+			break;
+	}
+	return {event.value, event.source, event.index, 0};
+}
+
+void args::arg_scanner::rewind(schema_lookup& lookup) {
+	switch (stop_) {
+		case stop::long_option:
+			retry_ = stopped_;
+			break;
+		case stop::short_option:
+			cluster_ = stopped_;
+			break;
+		case stop::positional:
+			positional(lookup, stopped_);
+			break;
+		case stop::none:
+			break;
+	}
+	stop_ = stop::none;
+}
+
+args::event_stream::event_stream(parser& p)
+    : parser_{&p}, scanner_{p.args_} {
+	p.start_parse();
+}
+
+args::event_stream::event_stream(parser& p,
+                                 std::vector<std::string_view> const& tokens)
+    : parser_{&p}, scanner_{arg_scanner::single_file(tokens)} {}
+
+bool args::event_stream::next(parse_event& event) {
+	auto& p = *parser_;
+	detail::action_lookup lookup{p};
+	[[maybe_unused]] auto const tokens = scanner_.tokens();
+
+	scan_event found{};
+	auto const has_event = scanner_.next(lookup, found);
+	if constexpr (instrumentation::enabled)
+		p.stats_.tokens += scanner_.tokens() - tokens;
+	if (!has_event) return false;
+
+	switch (found.kind) {
+		case scan_event::help:
+			p.attach_registered();
+			p.help(p.parse_width_);
+		case scan_event::missing_value:
+			p.argument_error(lng::needs_param, found.name);
+		case scan_event::unexpected_value:
+			p.argument_error(lng::needs_no_param, found.name);
+		case scan_event::misplaced_separator:
+			p.attach_registered();
+			p.error(p.tr()(lng::answer_file_separator), p.parse_width_);
+		case scan_event::unknown:
+			event = {nullptr,     0,           found.name, found.value,
+			         found.source, found.index};
+			if (scanner_.stopped() != arg_scanner::stop::none) {
+				unknown_ = event;
+				stopped_actions_ = p.actions_.size();
+			}
+			return true;
+		case scan_event::option:
+		case scan_event::positional:
+			break;
+	}
+
+	event = {p.actions_[found.action_id].get(),
+	         found.action_id,
+	         found.name,
+	         found.value,
+	         found.source,
+	         found.index};
+	return true;
+}
+
+args::unknown_arg args::event_stream::pass_through(
+    parse_event const& event) {
+	return scanner_.pass_through(
+	    {scan_event::unknown, schema_lookup::npos, event.name, event.value,
+	     event.index, event.source});
+}
+
+void args::event_stream::rewind() {
+	detail::action_lookup lookup{*parser_};
+	scanner_.rewind(lookup);
+}
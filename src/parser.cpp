@@ -3,9 +3,11 @@
 
 #include <args/parser.hpp>
 #include <args/sys.hpp>
+#include "dispatch.hpp"
+#include "watch.hpp"
 
-#include <cstring>
-#include <fstream>
+#include <algorithm>
+#include <filesystem>
 
 namespace {
 	inline std::string s(std::string_view sv) {
@@ -14,6 +16,11 @@ namespace {
 
 	inline std::string const& s(std::string const& in) { return in; }
 
+	inline void append_line(std::string& text, std::string const& line) {
+		if (!text.empty()) text.push_back('\n');
+		text.append(line);
+	}
+
 	inline args::chunk& make_title(args::chunk& part,
 	                               std::string title,
 	                               size_t count) {
@@ -40,79 +47,75 @@ namespace {
 		return to_name(std::string_view(&key, 1));
 	}
 
-	using actions_type = std::vector<std::unique_ptr<args::actions::action>>;
-	inline args::actions::action* find_by_name(std::string_view name,
-	                                           actions_type const& actions) {
-		for (auto& action : actions) {
-			if (!action->is(name)) continue;
-			return action.get();
+	std::string include_chain(
+	    std::vector<std::pair<std::string, std::string>> const& chain,
+	    std::string const& path) {
+		std::string result{};
+		for (auto const& [canonical, display] : chain) {
+			result.append(display);
+			result.append(" -> ");
 		}
-
-		return nullptr;
+		result.append(path);
+		return result;
 	}
 
-	inline args::actions::action* find_by_name(char name,
-	                                           actions_type const& actions) {
-		for (auto& action : actions) {
-			if (!action->is(name)) continue;
-			return action.get();
-		}
-
-		return nullptr;
-	}
-
-	struct args_list {
-		args::arglist args;
-		unsigned index{};
-		std::string_view current_value{};
-
-		using string_type = std::string_view;
-
-		bool next() {
-			if (args.size() == index) return false;
-			++index;
-			return true;
-		}
-
-		std::string_view argument() const noexcept { return args[index - 1]; }
-
-		void set_current(std::string_view curr) { current_value = curr; }
-		std::string_view current() const noexcept { return current_value; }
-
-		args::arglist unused() const noexcept {
-			auto ndx = index;
-			if (ndx) --ndx;
-			return args.shift(ndx);
-		}
+	// Thrown instead of exiting, while a reloaded answer file is tried.
+	struct reload_failure {
+		std::string message;
 	};
 
-	struct answer_file {
-		std::ifstream options{};
-		std::string current_line{};
-		std::string_view current_value{};
+	class reload_guard {
+	public:
+		explicit reload_guard(bool& flag) : flag_{flag} { flag_ = true; }
+		reload_guard(reload_guard const&) = delete;
+		reload_guard& operator=(reload_guard const&) = delete;
+		~reload_guard() { flag_ = false; }
 
-		using string_type = std::string*;
+	private:
+		bool& flag_;
+	};
 
-		bool next() {
-			bool whitespace_only = true;
-			while (whitespace_only) {
-				if (!std::getline(options, current_line)) return false;
+	using action_value = std::pair<size_t, std::string_view>;
+
+	std::vector<action_value> by_action(
+	    std::vector<args::parse_event> const& events) {
+		std::vector<action_value> values{};
+		values.reserve(events.size());
+		for (auto const& event : events)
+			values.emplace_back(event.action_id, event.value);
+		std::stable_sort(
+		    values.begin(), values.end(),
+		    [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+		return values;
+	}
 
-				for (auto c : current_line) {
-					if (!std::isspace(static_cast<unsigned char>(c))) {
-						whitespace_only = false;
-						break;
-					}
-				}
-			}
-			return true;
+	// Actions, which got different values, or the same values in different
+	// order; both lists are sorted by action.
+	std::vector<size_t> changed_actions(std::vector<action_value> const& before,
+	                                    std::vector<action_value> const& after) {
+		std::vector<size_t> changed{};
+		auto const group_end = [](auto it, auto end, size_t action) {
+			while (it != end && it->first == action)
+				++it;
+			return it;
+		};
+
+		auto lhs = before.begin();
+		auto rhs = after.begin();
+		while (lhs != before.end() || rhs != after.end()) {
+			auto const action =
+			    lhs == before.end()  ? rhs->first
+			    : rhs == after.end() ? lhs->first
+			                         : std::min(lhs->first, rhs->first);
+			auto const lhs_end = group_end(lhs, before.end(), action);
+			auto const rhs_end = group_end(rhs, after.end(), action);
+			if (!std::equal(lhs, lhs_end, rhs, rhs_end))
+				changed.push_back(action);
+			lhs = lhs_end;
+			rhs = rhs_end;
 		}
-
-		std::string const& argument() const noexcept { return current_line; }
-
-		void set_current(std::string_view curr) { current_value = curr; }
-		std::string_view current() const noexcept { return current_value; }
-	};
+		return changed;
+	}
 }  // namespace
 
 std::string_view args::arglist::program_name(std::string_view arg0) noexcept {
@@ -133,21 +136,138 @@ std::string_view args::arglist::program_name(std::string_view arg0) noexcept {
 	return arg0;
 }
 
-std::pair<size_t, size_t> args::parser::count_args() const noexcept {
-	size_t positionals = 0;
-	size_t arguments = provide_help_ ? 1 : 0;
+size_t args::parser::find_action(std::string_view name) const {
+	// used while the schema is defined, before the table is built
+	for (size_t index = 0; index < actions_.size(); ++index) {
+		auto const& action = *actions_[index];
+		if (name.length() == 1 ? dispatch::is(action, name[0])
+		                       : dispatch::is(action, name))
+			return index;
+	}
+	return action_table::npos;
+}
+
+std::string args::parser::argument_name(size_t index) const {
+	auto const names = dispatch::names(*actions_[index]);
+	if (names.empty()) return actions_[index]->meta(*tr_);
+	return to_name(names.front());
+}
+
+void args::parser::add_group(constraint::kind_type kind,
+                             std::initializer_list<std::string_view> names) {
+	constraint rule{};
+	rule.kind = kind;
+	rule.members.resize(actions_.size());
+	for (auto name : names)
+		rule.members.set(constraint_member(name));
+	constraints_.push_back(std::move(rule));
+}
+
+size_t args::parser::constraint_member(std::string_view name) const {
+	// a misspelled name would silently turn the constraint off
+	auto const index = find_action(name);
+	if (index == action_table::npos)
+		error(_(lng::undefined_argument, to_name(name)), parse_width_);
+	return index;
+}
+
+void args::parser::mutually_exclusive(
+    std::initializer_list<std::string_view> names) {
+	add_group(constraint::exclusive, names);
+}
 
-	for (auto& action : actions_) {
-		if (action->names().empty())
-			++positionals;
-		else
-			++arguments;
+void args::parser::at_least_one(
+    std::initializer_list<std::string_view> names) {
+	add_group(constraint::at_least_one, names);
+}
+
+void args::parser::depends(std::string_view name,
+                           std::string_view dependency) {
+	auto const dependent = constraint_member(name);
+	auto const dependee = constraint_member(dependency);
+
+	constraint rule{};
+	rule.kind = constraint::dependency;
+	rule.dependent = dependent;
+	rule.dependee = dependee;
+	constraints_.push_back(std::move(rule));
+}
+
+void args::parser::check_constraints(std::string& violations) const {
+	for (auto const& rule : constraints_) {
+		switch (rule.kind) {
+			case constraint::exclusive: {
+				if (bitset::count_and(rule.members, visited_) < 2) break;
+				auto first = action_table::npos;
+				bitset::for_each_and(
+				    rule.members, visited_, [&](size_t index) {
+					    if (first == action_table::npos) {
+						    first = index;
+						    return;
+					    }
+					    append_line(violations,
+					                _(lng::not_allowed_with,
+					                  argument_name(index),
+					                  argument_name(first)));
+				    });
+				break;
+			}
+			case constraint::at_least_one: {
+				if (bitset::count_and(rule.members, visited_)) break;
+				std::string names{};
+				rule.members.for_each([&](size_t index) {
+					if (!names.empty()) names.append(", ");
+					names.append(argument_name(index));
+				});
+				append_line(violations, _(lng::one_of_required, names));
+				break;
+			}
+			case constraint::dependency:
+				if (visited_.test(rule.dependent) &&
+				    !visited_.test(rule.dependee))
+					append_line(violations, _(lng::requires_argument,
+					                          argument_name(rule.dependent),
+					                          argument_name(rule.dependee)));
+				break;
+		}
+	}
+}
+
+void args::parser::plan_positionals() {
+	std::vector<positional_cursor<arg_token>::slot> slots{};
+	table_.positional.for_each([&](size_t index) {
+		slots.push_back({index, dispatch::nargs(*actions_[index]), 0});
+	});
+	positionals_.plan(std::move(slots));
+}
+
+void args::parser::check_positionals(std::string& violations) const {
+	for (auto const& slot : positionals_.slots()) {
+		if (slot.count >= slot.nargs.min) continue;
+		if (!slot.count) {
+			append_line(violations,
+			            _(lng::required, argument_name(slot.action)));
+			continue;
+		}
+		append_line(violations,
+		            _(lng::needs_params, argument_name(slot.action),
+		              std::to_string(slot.nargs.min)));
+	}
+}
+
+std::pair<size_t, size_t> args::parser::count_args() const {
+	size_t positionals = 0;
+	for (auto const& action : actions_) {
+		if (dispatch::names(*action).empty()) ++positionals;
 	}
+	auto const arguments =
+	    actions_.size() - positionals + (provide_help_ ? 1 : 0);
 
 	return {positionals, arguments};
 }
 
 void args::parser::printer_append_usage(std::string& shrt) const {
+	LIBARGS_STAGE(stats_, stage::printer);
 	shrt.append(prog_);
 
 	if (!usage_.empty()) {
@@ -157,10 +277,12 @@ void args::parser::printer_append_usage(std::string& shrt) const {
 		if (provide_help_) shrt.append(" [-h]");
 		for (auto& action : actions_)
 			action->append_short_help(*tr_, shrt);
+		shrt.append(usage_suffix_);
 	}
 }
 
 args::fmt_list args::parser::printer_arguments() const {
+	LIBARGS_STAGE(stats_, stage::printer);
 	auto [positionals, arguments] = count_args();
 	fmt_list info([](auto positionals, auto arguments) {
 		auto count = size_t{};
@@ -180,11 +302,14 @@ args::fmt_list args::parser::printer_arguments() const {
 			    std::make_pair("-h, --help", _(lng::help_description)));
 	}
 
-	for (auto& action : actions_) {
-		info[action->names().empty() ? 0 : args_id].items.push_back(
-		    std::make_pair(action->help_name(*tr_), action->help()));
+	for (auto const& action : actions_) {
+		auto const section = dispatch::names(*action).empty() ? 0 : args_id;
+		info[section].items.push_back(std::make_pair(
+		    action->help_name(*tr_), s(dispatch::help(*action))));
 	}
 
+	if (help_sections_) help_sections_(info);
+
 	return info;
 }
 
@@ -198,6 +323,8 @@ void args::parser::short_help(FILE* out,
 }
 
 void args::parser::help(std::optional<size_t> maybe_width) const {
+	if (reloading_) throw reload_failure{_(lng::unrecognized, "--help")};
+
 	short_help(stdout, false, maybe_width);
 
 	if (!description_.empty()) {
@@ -205,16 +332,29 @@ void args::parser::help(std::optional<size_t> maybe_width) const {
 		printer{stdout}.format_paragraph(description_, 0, maybe_width);
 	}
 
-	printer{stdout}.format_list(printer_arguments(), maybe_width);
+	// printer_arguments() times itself; only the formatting is timed here
+	auto const arguments = printer_arguments();
+	{
+		LIBARGS_STAGE(stats_, stage::printer);
+		printer{stdout}.format_list(arguments, maybe_width);
+	}
 
+	report_stats();
 	args::exit(0);
 }
 
 void args::parser::error(std::string const& msg,
                          std::optional<size_t> maybe_width) const {
+	if (reloading_) throw reload_failure{msg};
+
 	short_help(stderr, true, maybe_width);
-	printer{stderr}.format_paragraph(_(lng::error_msg, prog_, msg), 0,
-	                                 maybe_width);
+	{
+		LIBARGS_STAGE(stats_, stage::printer);
+		printer{stderr}.format_paragraph(_(lng::error_msg, prog_, msg), 0,
+		                                 maybe_width);
+	}
+
+	report_stats();
 	args::exit(2);
 }
 
@@ -236,152 +376,421 @@ std::string const& args::parser::usage() const noexcept {
 
 args::arglist args::parser::parse(unknown_action on_unknown,
                                   std::optional<size_t> maybe_width) {
-	parse_width_ = maybe_width;
-	args_list list{args_};
+	auto stream = events(maybe_width);
+
+	{
+		LIBARGS_STAGE(stats_, stage::parse);
+		parse_event event{};
+		while (stream.next(event)) {
+			if (event.action) {
+				apply(event);
+				continue;
+			}
+
+			if (on_unknown == exclusive_parser) unrecognized(event);
+
+			// the values held back for the trailing positionals are still
+			// owned by argv or the answer files
+			positionals_.finish([this](size_t index, arg_token const& token) {
+				apply({actions_[index].get(), index, {}, token.value,
+				       token.source, token.index});
+			});
+			convert_deferred();
+			report_stats();
+			return args_.shift(
+			    static_cast<unsigned>(stream.argument_index()));
+		}
+	}
 
-	if (!parse_list(list, on_unknown)) return list.unused();
+	validate();
+	report_stats();
+	return stream.rest();
+}
 
-	for (auto& action : actions_) {
-		if (action->required() && !action->visited()) {
-			std::string arg;
-			if (action->names().empty())
-				arg = action->meta(*tr_);
+args::arglist args::parser::parse_known(std::vector<unknown_arg>& unknown,
+                                        std::optional<size_t> maybe_width) {
+	unknown.clear();
+	auto stream = events(maybe_width);
+
+	{
+		LIBARGS_STAGE(stats_, stage::parse);
+		parse_event event{};
+		while (stream.next(event)) {
+			if (event.action)
+				apply(event);
 			else
-				arg = to_name(action->names().front());
-
-			error(_(lng::required, arg), maybe_width);
+				unknown.push_back(stream.pass_through(event));
 		}
 	}
 
-	return {};
+	validate();
+	report_stats();
+	return stream.rest();
 }
 
-template <typename ArgList>
-bool args::parser::parse_list(ArgList& list, unknown_action on_unknown) {
-	while (list.next()) {
-		auto&& arg = list.argument();
-		if (arg.length() > 1 && arg[0] == '-') {
-			if (arg.length() > 2 && arg[1] == '-') {
-				list.set_current(std::string_view{arg}.substr(2));
-				if (!parse_long(list, on_unknown)) return false;
-				continue;
-			}
+args::event_stream args::parser::events(std::optional<size_t> maybe_width) {
+	parse_width_ = maybe_width ? maybe_width : default_width_;
+	return event_stream{*this};
+}
 
-			list.set_current(std::string_view{arg}.substr(1));
-			if (!parse_short(list, on_unknown)) return false;
-			continue;
-		}
+std::optional<args::parse_event> args::parser::resume(
+    event_stream& stream) {
+	LIBARGS_STAGE(stats_, stage::parse);
+	if (stream.scanner_.stopped() != arg_scanner::stop::none) {
+		if (actions_.size() == stream.stopped_actions_)
+			unrecognized(stream.unknown_);
+		extend_parse(stream.stopped_actions_);
+		stream.rewind();
+	}
 
-		if (uses_answer_file() && arg.length() > 1 &&
-		    arg[0] == answer_file_marker()) {
-			if (!parse_answer_file(s(arg).substr(1), on_unknown)) return false;
-		} else {
-			if (!parse_positional(s(arg), on_unknown)) return false;
-		}
+	parse_event event{};
+	while (stream.next(event)) {
+		if (!event.action) return event;
+		apply(event);
 	}
 
-	return true;
+	validate();
+	report_stats();
+	return std::nullopt;
+}
+
+void args::parser::apply(parse_event const& event) {
+	if (!event.action) return;
+
+	visited_.set(event.action_id);
+	if (table_.needs_arg.test(event.action_id) ||
+	    table_.positional.test(event.action_id))
+		event.action->visit_view(*this, event.value);
+	else
+		event.action->visit(*this);
+}
+
+void args::parser::convert_deferred() {
+	// taken out first, in case a conversion error is thrown by a reload
+	auto const deferred = std::move(deferred_);
+	deferred_.clear();
+	for (auto values : deferred)
+		values->flush(*this);
+}
+
+void args::parser::validate() {
+	convert_deferred();
+	LIBARGS_STAGE(stats_, stage::validation);
+	// user actions may have been visited outside of apply()
+	table_.user.for_each([&](size_t index) {
+		if (actions_[index]->visited()) visited_.set(index);
+	});
+
+	std::string violations{};
+	bitset::for_each_and_not(table_.required, visited_, [&](size_t index) {
+		if (table_.positional.test(index)) return;
+		append_line(violations, _(lng::required, argument_name(index)));
+	});
+	check_positionals(violations);
+	check_constraints(violations);
+
+	if (violations.empty()) return;
+	attach_registered();
+	error(violations, parse_width_);
+}
+
+void args::parser::start_parse() {
+	table_.sync(actions_);
+	visited_.resize(actions_.size());
+	visited_.reset();
+	for (auto& [path, contents] : answer_cache_)
+		answer_arena_.push_back(std::move(contents));
+	answer_cache_.clear();
+	answer_chain_.clear();
+	plan_positionals();
+}
+
+void args::parser::extend_parse(size_t known_actions) {
+	table_.sync(actions_);
+	visited_.resize(actions_.size());
+
+	std::vector<positional_cursor<arg_token>::slot> slots{};
+	table_.positional.for_each([&](size_t index) {
+		if (index < known_actions) return;
+		slots.push_back({index, dispatch::nargs(*actions_[index]), 0});
+	});
+	if (!slots.empty()) positionals_.extend(slots);
+}
+
+void args::parser::unrecognized(parse_event const& event) {
+	attach_registered();
+	error(_(lng::unrecognized,
+	        event.name.empty() ? s(event.value) : to_name(event.name)),
+	      parse_width_);
+}
+
+void args::parser::argument_error(lng id, std::string_view name) {
+	attach_registered();
+	error(_(id, to_name(name)), parse_width_);
 }
 
-template <typename ArgList>
-bool args::parser::parse_long(ArgList& list, unknown_action on_unknown) {
-	auto name = list.current();
+namespace {
+	using actions_type = std::vector<std::unique_ptr<args::actions::action>>;
+
+	// First user action before the one found in the table, which matches
+	// the name; the user actions are looked up with the virtual is(), as
+	// the names they report may not be the ones they take.
+	template <typename Name>
+	size_t first_user(args::action_table const& table,
+	                  actions_type const& actions,
+	                  Name name,
+	                  size_t found) {
+		auto const last = std::min(found, actions.size());
+		for (auto index = table.user.find_first(); index < last; ++index) {
+			if (table.user.test(index) && actions[index]->is(name))
+				return index;
+		}
+		return found;
+	}
+}  // namespace
+
+size_t args::parser::lookup(std::string_view name) {
+	LIBARGS_COUNT(stats_, lookups);
+	auto const index = first_user(table_, actions_, name, table_.find(name));
+	if (index != action_table::npos) return index;
+	return attach_registered(name);
+}
 
-	if (provide_help_ && name == "help") help(parse_width_);
+size_t args::parser::lookup(char name) {
+	LIBARGS_COUNT(stats_, lookups);
+	auto const index = first_user(table_, actions_, name, table_.find(name));
+	if (index != action_table::npos) return index;
+	return attach_registered(name);
+}
 
-	auto pos = name.find('=');
-	auto const name_has_value = pos != std::string_view::npos;
-	auto const used_name = name.substr(0, pos);
+size_t args::parser::attach_registered_at(size_t registered) {
+	if (registered == option_registry::npos || attached_.test(registered))
+		return action_table::npos;
 
-	auto action = find_by_name(used_name, actions_);
+	attached_.set(registered);
+	auto const index = actions_.size();
+	registry_[registered]->attach(*this);
+	table_.sync(actions_);
+	visited_.resize(actions_.size());
+	return index;
+}
 
-	if (!action) {
-		if (on_unknown == exclusive_parser)
-			error(_(lng::unrecognized, to_name(used_name)), parse_width_);
-		return false;
+void args::parser::attach_registered() {
+	if (reloading_) return;
+	for (size_t index = 0; index < registry_.size(); ++index) {
+		if (!registry_[index] || attached_.test(index)) continue;
+		attached_.set(index);
+		registry_[index]->attach(*this);
 	}
+	table_.sync(actions_);
+	visited_.resize(actions_.size());
+}
+
+std::string_view args::parser::keep(std::string_view value) {
+	LIBARGS_COUNT(stats_, value_copies);
+	return arena_.emplace_front(value);
+}
+
+void args::parser::release_arena() {
+	watch_.reset();
+	answer_arena_.clear();
+	answer_arena_.shrink_to_fit();
+	arena_.clear();
+}
 
-	if (!action->needs_arg()) {
-		if (name_has_value)
-			error(_(lng::needs_no_param, to_name(used_name)), parse_width_);
+void args::parser::report_stats() const {
+	if constexpr (instrumentation::enabled) {
+		if (stats_sink_) stats_sink_(stats_);
+	}
+}
 
-		action->visit(*this);
-		return true;
+args::answer_file_contents const& args::parser::open_answer_file(
+    std::string const& path) {
+	std::error_code ec{};
+	auto canonical = std::filesystem::weakly_canonical(path, ec).string();
+	if (ec) canonical = path;
+
+	for (auto const& [included, display] : answer_chain_) {
+		if (included != canonical) continue;
+		attach_registered();
+		error(_(lng::answer_file_cycle, include_chain(answer_chain_, path)),
+		      parse_width_);
 	}
 
-	if (name_has_value) {
-		action->visit(*this, s(name.substr(pos + 1)));
-		return true;
+	if (answer_chain_.size() >= max_answer_file_depth_) {
+		attach_registered();
+		error(_(lng::answer_file_too_deep, include_chain(answer_chain_, path)),
+		      parse_width_);
 	}
 
-	if (list.next()) {
-		action->visit(*this, s(list.argument()));
-		return true;
+	auto it = answer_cache_.find(canonical);
+	if (it == answer_cache_.end()) {
+		answer_file_contents contents{};
+		{
+			LIBARGS_STAGE(stats_, stage::answer_files);
+			LIBARGS_COUNT(stats_, answer_files);
+			if (!contents.read(path, answer_dialect_)) {
+				attach_registered();
+				error(_(lng::file_not_found, path), parse_width_);
+			}
+		}
+		it = answer_cache_.emplace(canonical, std::move(contents)).first;
 	}
 
-	error(_(lng::needs_param, to_name(used_name)), parse_width_);
+	answer_chain_.emplace_back(std::move(canonical), path);
+	return it->second;
 }
 
-template <typename ArgList>
-bool args::parser::parse_short(ArgList& list, unknown_action on_unknown) {
-	auto argument = list.current();
-	auto length = argument.length();
-	for (decltype(length) index = 0; index < length; ++index) {
-		auto name = argument[index];
-		if (provide_help_ && name == 'h') help(parse_width_);
+void args::parser::close_answer_file() {
+	if (!answer_chain_.empty()) answer_chain_.pop_back();
+}
 
-		auto action = find_by_name(name, actions_);
+std::vector<args::parse_event> args::parser::rescan(
+    std::vector<std::string_view> const& tokens) {
+	std::vector<parse_event> events{};
+	event_stream stream{*this, tokens};
+	for (auto const& event : stream) {
+		if (event.action) events.push_back(event);
+	}
+	return events;
+}
 
-		if (!action) {
-			if (on_unknown == exclusive_parser)
-				error(_(lng::unrecognized, to_name(name)), parse_width_);
-			return false;
+void args::parser::watch_answer_files(reload_callback callback,
+                                      reload_error_callback on_error) {
+	if (watch_) {
+		// values taken from the reloads may still point into their text
+		for (auto& file : watch_->files) {
+			for (auto& generation : file.generations)
+				answer_arena_.push_back(std::move(generation.contents));
 		}
+	}
 
-		if (!action->needs_arg()) {
-			action->visit(*this);
-			continue;
-		}
+	auto watch = std::make_shared<answer_watch>();
+	watch->callback = std::move(callback);
+	watch->on_error = std::move(on_error);
+	watch->files.reserve(answer_cache_.size());
+	for (auto const& [path, contents] : answer_cache_)
+		watch->files.push_back({path, contents.tokens, {}, {}});
+	watch->start();
+	watch_ = std::move(watch);
+}
 
-		++index;
-		if (index < length) {
-			auto param = argument.substr(index);
-			index = length;
-			action->visit(*this, s(param));
-			continue;
-		}
+int args::parser::answer_files_handle() const noexcept {
+	return watch_ ? watch_->handle : -1;
+}
 
-		if (list.next()) {
-			action->visit(*this, s(list.argument()));
+size_t args::parser::reload_answer_files() {
+	if (!watch_) return 0;
+
+	size_t reloaded{};
+	for (auto const index : watch_->changed_files()) {
+		auto& file = watch_->files[index];
+		answer_file_contents contents{};
+		// a file removed for a moment is picked up, once it is back
+		if (!contents.read(file.path, answer_dialect_)) continue;
+
+		std::vector<parse_event> after{};
+		std::vector<size_t> changed{};
+		try {
+			reload_guard guard{reloading_};
+			after = rescan(contents.tokens);
+			changed = changed_actions(by_action(rescan(file.tokens)),
+			                          by_action(after));
+			for (auto const& event : after) {
+				if (std::binary_search(changed.begin(), changed.end(),
+				                       event.action_id))
+					event.action->check(*this, event.value);
+			}
+		} catch (reload_failure const& failure) {
+			if (watch_->on_error) watch_->on_error(file.path, failure.message);
 			continue;
 		}
 
-		error(_(lng::needs_param, to_name(name)), parse_width_);
+		++reloaded;
+		// the old tokens are still as good, the new text is not needed
+		if (changed.empty()) continue;
+
+		file.tokens = contents.tokens;
+		file.generations.push_back({std::move(contents), {}});
+		// no value of the changed options is kept from here on
+		release_generations(changed);
+
+		try {
+			reload_guard guard{reloading_};
+			reapply(changed, index, after);
+		} catch (reload_failure const& failure) {
+			// only callbacks, which cannot be checked up front, get here
+			if (watch_->on_error) watch_->on_error(file.path, failure.message);
+		}
+		// the values held back were checked with the rest of the file
+		convert_deferred();
+
+		if (!watch_->callback) continue;
+		std::vector<std::string> names{};
+		names.reserve(changed.size());
+		for (auto const action : changed)
+			names.push_back(argument_name(action));
+		watch_->callback(names);
 	}
-
-	return true;
+	return reloaded;
 }
 
-bool args::parser::parse_positional(std::string const& value,
-                                    unknown_action on_unknown) {
-	for (auto& action : actions_) {
-		if (!action->names().empty()) continue;
+void args::parser::reapply(std::vector<size_t> const& changed,
+                           size_t reloaded,
+                           std::vector<parse_event> const& events) {
+	// the options start over from their defaults and take the values of
+	// all the watched files, so that lists are replaced, not appended to,
+	// and an option gone from the file no longer keeps its old value
+	for (auto const action : changed)
+		actions_[action]->reset();
+
+	auto& files = watch_->files;
+	for (size_t index = 0; index < files.size(); ++index) {
+		auto& file = files[index];
+		std::vector<parse_event> rescanned{};
+		if (index != reloaded) rescanned = rescan(file.tokens);
+		auto const& source = index == reloaded ? events : rescanned;
+		// values taken from the text read by the parse need no generation
+		auto const generation =
+		    file.generations.empty() ? nullptr : &file.generations.back();
+		for (auto const& event : source) {
+			if (!std::binary_search(changed.begin(), changed.end(),
+			                        event.action_id))
+				continue;
+			apply(event);
+			if (generation) generation->actions.push_back(event.action_id);
+		}
 
-		action->visit(*this, value);
-		return true;
+		if (!generation) continue;
+		auto& actions = generation->actions;
+		std::sort(actions.begin(), actions.end());
+		actions.erase(std::unique(actions.begin(), actions.end()),
+		              actions.end());
 	}
-
-	if (on_unknown == exclusive_parser)
-		error(_(lng::unrecognized, value), parse_width_);
-	return false;
 }
 
-bool args::parser::parse_answer_file(std::string const& path,
-                                     unknown_action on_unknown) {
-	answer_file list{};
-	list.options.open(path);
-	if (list.options.fail()) error(_(lng::file_not_found, path), parse_width_);
-	return parse_list(list, on_unknown);
+void args::parser::release_generations(std::vector<size_t> const& changed) {
+	auto const was_changed = [&](size_t action) {
+		return std::binary_search(changed.begin(), changed.end(), action);
+	};
+	auto const unused = [](answer_watch::generation const& generation) {
+		return generation.actions.empty();
+	};
+
+	for (auto& file : watch_->files) {
+		auto& generations = file.generations;
+		for (auto& generation : generations) {
+			auto& actions = generation.actions;
+			actions.erase(
+			    std::remove_if(actions.begin(), actions.end(), was_changed),
+			    actions.end());
+		}
+		if (generations.empty()) continue;
+		// the last generation holds the tokens of the file
+		auto const last = std::prev(generations.end());
+		generations.erase(
+		    std::remove_if(generations.begin(), last, unused), last);
+	}
 }
 
 #if defined(HAS_STD_CONCEPTS)
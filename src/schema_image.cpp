@@ -0,0 +1,383 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/schema_image.hpp>
+#include "dispatch.hpp"
+
+#include <algorithm>
+
+namespace {
+	using word_type = std::uint32_t;
+
+	word_type to_word(size_t value) noexcept {
+		return static_cast<word_type>(value);
+	}
+
+	void append_words(std::string& out, std::vector<word_type> const& words) {
+		auto const offset = out.size();
+		out.resize(offset + words.size() * sizeof(word_type));
+		if (!words.empty())
+			std::memcpy(out.data() + offset, words.data(),
+			            words.size() * sizeof(word_type));
+	}
+}  // namespace
+
+std::string args::parser::freeze() const {
+	using view = schema_view;
+	// the schema may be frozen without a parse, so the table is built here
+	action_table table{};
+	table.sync(actions_);
+
+	auto const count = actions_.size();
+	std::vector<word_type> words(
+	    view::header_size + view::short_names_size + count * view::action_size);
+	std::vector<word_type> names{};
+	std::vector<word_type> positionals{};
+	std::string pool{};
+
+	struct long_name {
+		std::string_view name;
+		word_type offset;
+		word_type action;
+	};
+	std::vector<long_name> long_names{};
+
+	auto const add_text = [&](std::string_view text) {
+		auto const offset = to_word(pool.size());
+		pool.append(text);
+		return std::pair{offset, to_word(text.length())};
+	};
+
+	for (size_t index = 0; index < count; ++index) {
+		auto const& action = *actions_[index];
+		auto const fields =
+		    words.data() + view::header_size + view::short_names_size +
+		    index * view::action_size;
+
+		word_type flags{};
+		if (table.needs_arg.test(index)) flags |= view::needs_arg_flag;
+		if (table.required.test(index)) flags |= view::required_flag;
+		if (table.multiple.test(index)) flags |= view::multiple_flag;
+		if (table.positional.test(index)) {
+			flags |= view::positional_flag;
+			positionals.push_back(to_word(index));
+		}
+		fields[view::action_flags] = flags;
+
+		auto const action_names = dispatch::names(action);
+		fields[view::action_first_name] =
+		    to_word(names.size() / view::name_size);
+		fields[view::action_name_count] = to_word(action_names.size());
+		for (auto name : action_names) {
+			auto const [offset, length] = add_text(name);
+			names.push_back(offset);
+			names.push_back(length);
+
+			if (length == 1) {
+				// first action with the name wins, as it does in the parser
+				auto& slot = words[view::header_size +
+				                   static_cast<unsigned char>(name[0])];
+				if (!slot) slot = to_word(index + 1);
+			} else if (length > 1) {
+				long_names.push_back({name, offset, to_word(index)});
+			}
+		}
+
+		std::tie(fields[view::action_meta], fields[view::action_meta_length]) =
+		    add_text(action.meta(*tr_));
+		std::tie(fields[view::action_help], fields[view::action_help_length]) =
+		    add_text(dispatch::help(action));
+
+		auto const values = dispatch::nargs(action);
+		fields[view::action_min] = values.min;
+		fields[view::action_max] = values.max;
+	}
+
+	std::sort(long_names.begin(), long_names.end(),
+	          [](long_name const& lhs, long_name const& rhs) {
+		          if (lhs.name != rhs.name) return lhs.name < rhs.name;
+		          return lhs.action < rhs.action;
+	          });
+	std::vector<word_type> long_words{};
+	long_words.reserve(long_names.size() * view::long_name_size);
+	for (auto const& name : long_names) {
+		long_words.push_back(name.offset);
+		long_words.push_back(to_word(name.name.length()));
+		long_words.push_back(name.action);
+	}
+
+	// one record per constraint, with the members as a bitmask
+	auto const rule_size = view::rule_members + (count + 31) / 32;
+	std::vector<word_type> rules(constraints_.size() * rule_size);
+	for (size_t index = 0; index < constraints_.size(); ++index) {
+		auto const& rule = constraints_[index];
+		auto const record = rules.data() + index * rule_size;
+		record[view::rule_kind] = to_word(rule.kind);
+		record[view::rule_dependent] = to_word(rule.dependent);
+		record[view::rule_dependee] = to_word(rule.dependee);
+		rule.members.for_each([&](size_t member) {
+			record[view::rule_members + member / 32] |=
+			    word_type{1} << (member % 32);
+		});
+	}
+
+	words[view::field_magic] = view::magic;
+	words[view::field_byte_order] = view::byte_order;
+	words[view::field_version] = view::version;
+	words[view::field_actions] = to_word(count);
+	words[view::field_names] = to_word(names.size() / view::name_size);
+	words[view::field_long_names] = to_word(long_names.size());
+	words[view::field_positionals] = to_word(positionals.size());
+	words[view::field_constraints] = to_word(constraints_.size());
+	words[view::field_flags] = (provide_help_ ? view::help_flag : 0) |
+	                           (stop_at_positional_ ? view::stop_flag : 0);
+	words[view::field_pool] = to_word(pool.size());
+
+	std::string image{};
+	image.reserve((words.size() + names.size() + long_words.size() +
+	               positionals.size() + rules.size()) *
+	                  sizeof(word_type) +
+	              pool.size());
+	append_words(image, words);
+	append_words(image, names);
+	append_words(image, long_words);
+	append_words(image, positionals);
+	append_words(image, rules);
+	image.append(pool);
+	return image;
+}
+
+args::schema_view::schema_view(std::string_view image) noexcept
+    : image_{image} {
+	error_ = check();
+	if (error_ != image_error::none) image_ = {};
+}
+
+args::schema_view::image_error args::schema_view::check() const noexcept {
+	// sizes are added up in 64 bits, so that no header overflows them
+	using wide = std::uint64_t;
+
+	if (image_.size() < header_size * sizeof(word_type) ||
+	    word(field_magic) != magic)
+		return image_error::not_an_image;
+	if (word(field_byte_order) != byte_order) return image_error::byte_order;
+	if (word(field_version) != version) return image_error::version;
+
+	wide const count = word(field_actions);
+	wide const name_count = word(field_names);
+	wide const long_count = word(field_long_names);
+	wide const positional_count = word(field_positionals);
+	wide const rule_count = word(field_constraints);
+	wide const pool_size = word(field_pool);
+	wide const rule_size = rule_members + (count + 31) / 32;
+	wide const words = header_size + short_names_size + count * action_size +
+	                   name_count * name_size + long_count * long_name_size +
+	                   positional_count + rule_count * rule_size;
+	if (words * sizeof(word_type) + pool_size != image_.size())
+		return image_error::size;
+
+	auto const in_pool = [pool_size](wide offset, wide length) {
+		return offset + length <= pool_size;
+	};
+
+	for (size_t name = 0; name < short_names_size; ++name) {
+		if (word(short_names() + name) > count)
+			return image_error::out_of_range;
+	}
+
+	for (size_t action = 0; action < count; ++action) {
+		if (wide{field(action, action_first_name)} +
+		            field(action, action_name_count) >
+		        name_count ||
+		    !in_pool(field(action, action_meta),
+		             field(action, action_meta_length)) ||
+		    !in_pool(field(action, action_help),
+		             field(action, action_help_length)))
+			return image_error::out_of_range;
+	}
+
+	for (size_t entry = 0; entry < name_count; ++entry) {
+		auto const at = names() + entry * name_size;
+		if (!in_pool(word(at), word(at + 1)))
+			return image_error::out_of_range;
+	}
+
+	// find() needs the long names in order
+	std::string_view previous{};
+	for (size_t entry = 0; entry < long_count; ++entry) {
+		auto const at = long_names() + entry * long_name_size;
+		if (!in_pool(word(at), word(at + 1)) || word(at + 2) >= count)
+			return image_error::out_of_range;
+		auto const name = pool_text(word(at), word(at + 1));
+		if (entry && name < previous) return image_error::out_of_range;
+		previous = name;
+	}
+
+	for (size_t entry = 0; entry < positional_count; ++entry) {
+		if (word(positionals() + entry) >= count)
+			return image_error::out_of_range;
+	}
+
+	auto const tail = count % 32;
+	for (size_t rule = 0; rule < rule_count; ++rule) {
+		auto const kind = rule_word(rule, rule_kind);
+		auto const dependency = word_type{constraint::dependency};
+		if (kind > dependency) return image_error::out_of_range;
+		if (kind == dependency &&
+		    (rule_word(rule, rule_dependent) >= count ||
+		     rule_word(rule, rule_dependee) >= count))
+			return image_error::out_of_range;
+		// no member past the last action
+		if (tail && rule_word(rule, rule_size - 1) >> tail)
+			return image_error::out_of_range;
+	}
+
+	return image_error::none;
+}
+
+size_t args::schema_view::find(std::string_view name) const noexcept {
+	auto const entry_text = [this](size_t entry) {
+		auto const at = long_names() + entry * long_name_size;
+		return pool_text(word(at), word(at + 1));
+	};
+
+	size_t first{};
+	size_t last = word(field_long_names);
+	while (first < last) {
+		auto const middle = first + (last - first) / 2;
+		if (entry_text(middle) < name)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	if (first == word(field_long_names) || entry_text(first) != name)
+		return npos;
+	return word(long_names() + first * long_name_size + 2);
+}
+
+size_t args::schema_view::find(char name) const noexcept {
+	auto const action =
+	    word(short_names() + static_cast<unsigned char>(name));
+	return action ? action - 1 : npos;
+}
+
+std::string_view args::schema_view::name(size_t action,
+                                         size_t index) const noexcept {
+	if (index >= name_count(action)) return {};
+	auto const at =
+	    names() + (field(action, action_first_name) + index) * name_size;
+	return pool_text(word(at), word(at + 1));
+}
+
+// The image, as seen by the scanner; there are no answer files in it.
+class args::schema_view::scanner::lookup final : public schema_lookup {
+public:
+	explicit lookup(scanner& owner) noexcept : owner_{owner} {}
+
+	size_t find(std::string_view name) override {
+		return owner_.schema_->find(name);
+	}
+	size_t find(char name) override { return owner_.schema_->find(name); }
+	bool needs_arg(size_t action) override {
+		return owner_.schema_->needs_arg(action);
+	}
+	bool provides_help() override { return owner_.schema_->provides_help(); }
+	positional_cursor<arg_token>& positionals() override {
+		return owner_.positionals_;
+	}
+	bool stops_at_positional() override {
+		return owner_.schema_->stops_at_positional();
+	}
+
+private:
+	scanner& owner_;
+};
+
+args::schema_view::scanner::scanner(schema_view const& schema,
+                                    arglist const& args)
+    : schema_{&schema}, scanner_{args} {
+	seen_.resize(schema.size());
+
+	std::vector<positional_cursor<arg_token>::slot> slots{};
+	auto const count = schema.word(field_positionals);
+	slots.reserve(count);
+	for (size_t index = 0; index < count; ++index) {
+		auto const action = schema.word(schema.positionals() + index);
+		slots.push_back({action, schema.nargs(action), 0});
+	}
+	positionals_.plan(std::move(slots));
+}
+
+bool args::schema_view::scanner::next(event& ev) {
+	lookup schema{*this};
+	if (!scanner_.next(schema, ev)) return false;
+	if (ev.kind == event::option || ev.kind == event::positional)
+		seen_.set(ev.action_id);
+	return true;
+}
+
+std::vector<args::schema_view::violation>
+args::schema_view::scanner::violations() const {
+	auto const& schema = *schema_;
+	std::vector<violation> result{};
+	for (size_t action = 0; action < schema.size(); ++action) {
+		if (schema.required(action) && !schema.positional(action) &&
+		    !seen_.test(action))
+			result.push_back({violation::required, action});
+	}
+
+	for (auto const& slot : positionals_.slots()) {
+		if (slot.count >= slot.nargs.min) continue;
+		result.push_back({slot.count ? violation::needs_params
+		                             : violation::required,
+		                  slot.action});
+	}
+
+	// the members of a rule, which were seen, 32 at a time
+	auto const mask_words = (schema.size() + 31) / 32;
+	auto const seen_members = [&](size_t rule, size_t index) {
+		auto const seen = seen_.words()[index / 2] >> (index % 2 * 32);
+		return schema.rule_word(rule, rule_members + index) &
+		       static_cast<word_type>(seen);
+	};
+
+	for (size_t rule = 0; rule < schema.constraint_count(); ++rule) {
+		switch (schema.constraint_kind(rule)) {
+			case constraint::exclusive: {
+				auto first = npos;
+				for (size_t index = 0; index < mask_words; ++index) {
+					for (auto members = seen_members(rule, index); members;
+					     members &= members - 1) {
+						auto const action =
+						    index * 32 + bitset::lowest_bit(members);
+						if (first == npos)
+							first = action;
+						else
+							result.push_back({violation::not_allowed_with,
+							                  action, first, rule});
+					}
+				}
+				break;
+			}
+			case constraint::at_least_one: {
+				auto found = false;
+				for (size_t index = 0; index < mask_words && !found; ++index)
+					found = seen_members(rule, index) != 0;
+				if (!found)
+					result.push_back(
+					    {violation::one_of_required, npos, npos, rule});
+				break;
+			}
+			case constraint::dependency: {
+				auto const dependent = schema.rule_word(rule, rule_dependent);
+				auto const dependee = schema.rule_word(rule, rule_dependee);
+				if (seen_.test(dependent) && !seen_.test(dependee))
+					result.push_back({violation::requires_argument, dependent,
+					                  dependee, rule});
+				break;
+			}
+		}
+	}
+	return result;
+}
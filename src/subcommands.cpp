@@ -0,0 +1,86 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include <args/subcommands.hpp>
+#include <utility>
+
+namespace {
+	class prepared_guard {
+	public:
+		prepared_guard(args::parser const*& slot, args::parser const* value)
+		    : slot_{slot}, previous_{std::exchange(slot, value)} {}
+		prepared_guard(prepared_guard const&) = delete;
+		prepared_guard& operator=(prepared_guard const&) = delete;
+		~prepared_guard() { slot_ = previous_; }
+
+	private:
+		args::parser const*& slot_;
+		args::parser const* previous_;
+	};
+}  // namespace
+
+args::subcommands::subcommands(std::initializer_list<command> commands) {
+	commands_.reserve(commands.size());
+	index_.reserve(commands.size());
+	for (auto const& cmd : commands)
+		add(cmd);
+}
+
+void args::subcommands::add(command cmd) {
+	// the first command with the name wins, as with the arguments
+	if (!index_.emplace(cmd.name.view(), commands_.size()).second) return;
+	commands_.push_back(std::move(cmd));
+}
+
+args::subcommands::command const* args::subcommands::find(
+    std::string_view name) const {
+	auto const it = index_.find(std::string{name});
+	if (it == index_.end()) return nullptr;
+	return &commands_[it->second];
+}
+
+int args::subcommands::run(parser& p, std::optional<size_t> maybe_width) {
+	auto const& tr = p.tr();
+	if (common_ && &p != prepared_) common_(p);
+
+	std::string usage_suffix{" "};
+	usage_suffix.append(tr(lng::command_meta));
+	usage_suffix.append(" ...");
+	p.extend_help(std::move(usage_suffix), [this, &tr](fmt_list& info) {
+		auto& section = info.emplace_back();
+		section.title = tr(lng::commands);
+		section.items.reserve(commands_.size());
+		for (auto const& cmd : commands_)
+			section.items.emplace_back(std::string{cmd.name.view()},
+			                           std::string{cmd.help.view()});
+	});
+
+	auto const rest = p.parse(parser::allow_subcommands, maybe_width);
+	auto const width = p.parse_width();
+	if (rest.empty()) {
+		p.attach_registered();
+		p.error(tr(lng::required, tr(lng::command_meta)), width);
+	}
+
+	auto const name = rest[0];
+	if (name.length() > 1 && name[0] == '-') {
+		p.attach_registered();
+		p.error(tr(lng::unrecognized, name), width);
+	}
+
+	auto const cmd = find(name);
+	if (!cmd) {
+		p.attach_registered();
+		p.error(tr(lng::unknown_command, name), width);
+	}
+
+	std::string progname{p.program()};
+	progname.push_back(' ');
+	progname.append(name);
+
+	parser sub{std::string{cmd->help.view()}, progname, rest.shift(), &tr};
+	sub.default_width(width);
+	if (common_) common_(sub);
+	prepared_guard guard{prepared_, &sub};
+	return cmd->run(sub);
+}
@@ -46,6 +46,33 @@ std::string args::null_translator::operator()(lng id,
 			return s(arg1) + ": error: " + s(arg2);
 		case lng::file_not_found:
 			return "cannot open " + s(arg1);
+		case lng::not_allowed_with:
+			return "argument " + s(arg1) + ": not allowed with argument " +
+			       s(arg2);
+		case lng::one_of_required:
+			return "one of the arguments " + s(arg1) + " is required";
+		case lng::requires_argument:
+			return "argument " + s(arg1) + " requires argument " + s(arg2);
+		case lng::answer_file_cycle:
+			return "answer file includes itself: " + s(arg1);
+		case lng::answer_file_too_deep:
+			return "answer files nested too deeply: " + s(arg1);
+		case lng::needs_params:
+			return "argument " + s(arg1) + ": expected " + s(arg2) +
+			       " arguments";
+		case lng::commands:
+			return "commands";
+		case lng::command_meta:
+			return "COMMAND";
+		case lng::unknown_command:
+			return "unrecognized command: " + s(arg1);
+		case lng::undefined_argument:
+			return "constraint names an undefined argument: " + s(arg1);
+		case lng::single_value_nargs:
+			return "argument " + s(arg1) +
+			       ": nargs allows more values than the storage holds";
+		case lng::answer_file_separator:
+			return "-- cannot end the options inside an answer file";
 	}
 	return "<unrecognized string>";
 }
@@ -0,0 +1,96 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#include "watch.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace args {
+	answer_watch::~answer_watch() {
+#if defined(__linux__)
+		if (handle >= 0) ::close(handle);
+#endif
+	}
+
+	void answer_watch::start() {
+		for (auto& file : files) {
+			std::error_code ec{};
+			file.modified = std::filesystem::last_write_time(file.path, ec);
+		}
+
+#if defined(__linux__)
+		handle = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (handle < 0) return;
+
+		// editors tend to replace the file instead of writing it over,
+		// so it is the directory, which is watched
+		for (auto const& file : files) {
+			auto dir = std::filesystem::path{file.path}.parent_path();
+			auto const known =
+			    std::any_of(dirs_.begin(), dirs_.end(),
+			                [&](auto const& entry) { return entry.second == dir; });
+			if (known) continue;
+
+			auto const wd = ::inotify_add_watch(handle, dir.c_str(),
+			                                    IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (wd < 0) continue;
+			dirs_.emplace_back(wd, std::move(dir));
+		}
+#endif
+	}
+
+	std::vector<size_t> answer_watch::changed_files() {
+		std::vector<size_t> changed{};
+		auto const mark = [&](size_t index) {
+			if (std::find(changed.begin(), changed.end(), index) ==
+			    changed.end())
+				changed.push_back(index);
+		};
+
+#if defined(__linux__)
+		if (handle >= 0) {
+			alignas(inotify_event) char buffer[4096];
+			while (true) {
+				auto const length = ::read(handle, buffer, sizeof(buffer));
+				if (length <= 0) break;
+
+				auto const size = static_cast<size_t>(length);
+				for (size_t pos{}; pos + sizeof(inotify_event) <= size;) {
+					inotify_event event{};
+					std::memcpy(&event, buffer + pos, sizeof(event));
+					char const* name = buffer + pos + sizeof(event);
+					pos += sizeof(event) + event.len;
+					if (!event.len) continue;
+
+					auto const dir = std::find_if(
+					    dirs_.begin(), dirs_.end(),
+					    [&](auto const& entry) { return entry.first == event.wd; });
+					if (dir == dirs_.end()) continue;
+
+					auto const path = (dir->second / name).string();
+					for (size_t index{}; index < files.size(); ++index) {
+						if (files[index].path == path) mark(index);
+					}
+				}
+			}
+			return changed;
+		}
+#endif
+
+		for (size_t index{}; index < files.size(); ++index) {
+			auto& file = files[index];
+			std::error_code ec{};
+			auto const modified =
+			    std::filesystem::last_write_time(file.path, ec);
+			if (ec || modified == file.modified) continue;
+			file.modified = modified;
+			mark(index);
+		}
+		return changed;
+	}
+}  // namespace args
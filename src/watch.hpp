@@ -0,0 +1,47 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/parser.hpp>
+#include <filesystem>
+
+namespace args {
+	// Answer files read by the last parse, together with the arguments found
+	// in them the last time they were read. On Linux the changes are
+	// reported by inotify, elsewhere by the modification time of the files.
+	struct answer_watch {
+		// Text of one reload of a file, kept alive for as long as any of the
+		// actions, which took a value from it, still holds that value. The
+		// text read by the parse itself is owned by the parser and has no
+		// generation.
+		struct generation {
+			answer_file_contents contents{};
+			std::vector<size_t> actions{};
+		};
+
+		struct file {
+			std::string path{};
+			std::vector<std::string_view> tokens{};
+			std::filesystem::file_time_type modified{};
+			std::vector<generation> generations{};
+		};
+
+		answer_watch() = default;
+		answer_watch(answer_watch const&) = delete;
+		answer_watch& operator=(answer_watch const&) = delete;
+		~answer_watch();
+
+		void start();
+		// Indices of the files changed since the last call.
+		std::vector<size_t> changed_files();
+
+		std::vector<file> files{};
+		parser::reload_callback callback{};
+		parser::reload_error_callback on_error{};
+		int handle{-1};
+
+	private:
+		std::vector<std::pair<int, std::filesystem::path>> dirs_{};
+	};
+}  // namespace args
@@ -0,0 +1,238 @@
+#include <args/bind.hpp>
+#include <args/parser.hpp>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include "test-runner.hpp"
+
+using namespace std::literals;
+using namespace args::literals;
+
+namespace {
+	size_t g_allocations{};
+}
+
+void* operator new(std::size_t size) {
+	++g_allocations;
+	if (auto ptr = std::malloc(size ? size : 1)) return ptr;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+enum class mode { slow, fast, auto_ };
+
+ENUM_TRAITS_BEGIN(mode)
+ENUM_TRAITS_NAME(slow)
+ENUM_TRAITS_NAME(fast)
+ENUM_TRAITS_NAME_EX(mode::auto_, "auto")
+ENUM_TRAITS_END(mode)
+
+struct options {
+	int level{};
+	unsigned jobs{};
+	long long threshold{};
+	mode how{mode::slow};
+	bool verbose{false};
+	bool quiet{false};
+};
+
+void define_schema(args::parser& p, options& opts) {
+	p.arg(opts.level, "level"_lit).opt();
+	p.arg(opts.jobs, "j"_lit, "jobs"_lit).opt();
+	p.arg(opts.threshold, "verbosity-threshold"_lit).opt();
+	p.arg(opts.how, "mode"_lit).opt();
+	p.set<std::true_type>(opts.verbose, "v"_lit, "verbose"_lit).opt();
+	p.set<std::true_type>(opts.quiet, "q"_lit).opt();
+}
+
+template <typename... Token>
+size_t parse_allocations(size_t repeats, Token... pattern) {
+	std::vector<std::string> tokens;
+	tokens.reserve(1 + repeats * sizeof...(Token));
+	tokens.push_back("alloc-test");
+	for (size_t index = 0; index < repeats; ++index)
+		(tokens.push_back(pattern), ...);
+
+	test_args cmd{std::move(tokens)};
+
+	options opts{};
+	args::null_translator tr;
+	args::parser p{"allocation budget", cmd.view(), &tr};
+	define_schema(p, opts);
+
+	auto const before = g_allocations;
+	p.parse();
+	return g_allocations - before;
+}
+
+// how many more allocations are made, when the pattern is repeated thousand
+// times instead of once; any cost per token shows up here
+template <typename... Token>
+size_t allocations_for_tokens(Token... pattern) {
+	auto const single = parse_allocations(1, pattern...);
+	auto const many = parse_allocations(1000, pattern...);
+	return many - single;
+}
+
+void BUDGET_impl(size_t actual,
+                 size_t budget,
+                 const char* actual_name,
+                 const char* budget_name) {
+	if (actual <= budget) return;
+	std::cerr << "Allocation budget exceeded:\n " << actual_name
+	          << "\n    Which is: " << actual << "\n " << budget_name
+	          << "\n    Which is: " << budget << "\n";
+	std::exit(1);
+}
+
+#define BUDGET(actual, budget) BUDGET_impl(actual, budget, #actual, #budget)
+
+TEST(schema_budget) {
+	test_args cmd{test_program{"alloc-test"}};
+
+	args::null_translator tr;
+	auto const before = g_allocations;
+	{
+		options opts{};
+		args::parser p{"allocation budget", cmd.view(), &tr};
+		define_schema(p, opts);
+
+		// one action object per option, plus the growth of the action list;
+		// literal names are not copied, but the description outgrows the
+		// small string buffer
+		constexpr size_t options_defined = 6;
+		constexpr size_t list_growth = 4;
+		constexpr size_t long_strings = 1;
+		BUDGET(g_allocations - before,
+		       options_defined + list_growth + long_strings);
+	}
+
+	return 0;
+}
+
+TEST(literal_registration_is_free) {
+	test_args cmd{test_program{"alloc-test"}};
+
+	std::string output;
+	args::null_translator tr;
+	args::parser p{"", cmd.view(), &tr};
+
+	auto const before = g_allocations;
+	p.arg(output, "o"_lit, "output"_lit, "output-file"_lit)
+	    .meta("OUTPUT-FILE-NAME"_lit)
+	    .help(args::literal{
+	        "name of the file to write the results to, instead of stdout"});
+
+	// the action object itself and the first slot in the action list
+	BUDGET(g_allocations - before, 2u);
+	return 0;
+}
+
+TEST(parse_budget) {
+	// the action table needs the name pool, the long name list and the
+	// first name list; the name of --verbosity-threshold is cached for the
+	// error messages
+	constexpr size_t action_table = 3;
+	constexpr size_t long_names = 1;
+	BUDGET(parse_allocations(1, "--level", "5", "-j8", "--mode=fast", "-vq",
+	                         "--verbosity-threshold", "12"),
+	       action_table + long_names);
+	return 0;
+}
+
+TEST(int_tokens_are_free) {
+	EQ(0u, allocations_for_tokens("--level", "5", "-j", "8", "-j16",
+	                             "--jobs=32",
+	                             "--verbosity-threshold=123456789012"));
+	return 0;
+}
+
+TEST(enum_tokens_are_free) {
+	EQ(0u, allocations_for_tokens("--mode", "fast", "--mode=auto"));
+	return 0;
+}
+
+TEST(flag_tokens_are_free) {
+	EQ(0u, allocations_for_tokens("-v", "--verbose", "-vq", "-q"));
+	return 0;
+}
+
+TEST(streamed_positionals_are_free) {
+	auto const parse = [](size_t repeats) {
+		std::vector<std::string> tokens(
+		    repeats + 1, "a/path/long/enough/for/the/heap/to/be/used");
+		test_args cmd{std::move(tokens)};
+
+		size_t seen{};
+		args::null_translator tr;
+		args::parser p{"allocation budget", cmd.view(), &tr};
+		p.stream([&](std::string_view) { ++seen; });
+
+		auto const before = g_allocations;
+		p.parse();
+		return g_allocations - before;
+	};
+
+	EQ(parse(1), parse(1000));
+	return 0;
+}
+
+TEST(string_view_tokens_are_free) {
+	auto const parse = [](size_t repeats) {
+		std::vector<std::string> tokens{"alloc-test"};
+		for (size_t index = 0; index < repeats; ++index) {
+			tokens.push_back("--name");
+			tokens.push_back("a/value/long/enough/for/the/heap/to/be/used");
+			tokens.push_back("-p/another/value/long/enough/for/the/heap");
+		}
+		test_args cmd{std::move(tokens)};
+
+		std::string_view name;
+		char const* path{};
+		args::null_translator tr;
+		args::parser p{"allocation budget", cmd.view(), &tr};
+		p.arg(name, "name");
+		p.arg(path, "p");
+
+		auto const before = g_allocations;
+		p.parse();
+		return g_allocations - before;
+	};
+
+	EQ(parse(1), parse(1000));
+	return 0;
+}
+
+constexpr args::struct_schema bound_schema{
+    args::field(&options::level, "level").opt(),
+    args::field(&options::jobs, "jobs", 'j').opt(),
+    args::field(&options::how, "mode").opt(),
+    args::field(&options::verbose, "verbose", 'v'),
+    args::field(&options::quiet, 'q'),
+};
+
+TEST(bound_struct_is_free) {
+	test_args cmd{test_program{"alloc-test"}, "--level", "5", "-j8",
+	              "--mode=fast", "-vq"};
+
+	options opts{};
+	args::null_translator tr;
+	args::parser p{"allocation budget", cmd.view(), &tr};
+
+	auto const before = g_allocations;
+	bound_schema.parse(p, opts);
+	EQ(size_t{}, g_allocations - before);
+	EQ(5, opts.level);
+	EQ(8u, opts.jobs);
+	EQ(true, opts.how == mode::fast);
+	EQ(true, opts.verbose);
+	EQ(true, opts.quiet);
+	return 0;
+}
@@ -1,57 +1,23 @@
+#include <args/bind.hpp>
 #include <args/parser.hpp>
+#include <args/schema_image.hpp>
+#include <args/subcommands.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <string_view>
+#include <thread>
+#include "test-runner.hpp"
 
 using namespace std::literals;
 
-struct test {
-	const char* title;
-	int (*callback)();
-	int expected{0};
-	std::string_view output{};
-};
-
-std::vector<test> g_tests;
-
-template <typename Test>
-struct registrar {
-	registrar() {
-		::g_tests.push_back(
-		    {Test::get_name(), Test::run, Test::expected(), Test::output()});
-	}
-};
-
-#define TEST_BASE(name, EXPECTED, OUTPUT)                            \
-	struct test_##name {                                             \
-		static const char* get_name() noexcept { return #name; }     \
-		static int run();                                            \
-		static int expected() noexcept { return (EXPECTED); }        \
-		static std::string_view output() noexcept { return OUTPUT; } \
-	};                                                               \
-	registrar<test_##name> reg_##name;                               \
-	int test_##name ::run()
-
-#define TEST(name) TEST_BASE(name, 0, {})
-#define TEST_FAIL(name) TEST_BASE(name, 1, {})
-#define TEST_OUT(name, OUTPUT) TEST_BASE(name, 0, OUTPUT)
-#define TEST_FAIL_OUT(name, OUTPUT) TEST_BASE(name, 1, OUTPUT)
-
-int main(int argc, char* argv[]) {
-	if (argc == 1) {
-		for (auto const& test : g_tests) {
-			printf("%d:%s:", test.expected, test.title);
-			if (!test.output.empty())
-				printf("%.*s", static_cast<int>(test.output.size()),
-				       test.output.data());
-			putc('\n', stdout);
-		}
-		return 0;
-	}
-
-	auto const int_test = atoi(argv[1]);
-	if (int_test < 0) return 100;
-	auto const test = static_cast<size_t>(int_test);
-	return g_tests[test].callback();
+// tests may run in parallel, each one needs its own file
+std::string unique_temp_path(std::string const& name) {
+	auto const suffix = std::to_string(std::random_device{}());
+	return (std::filesystem::temp_directory_path() / (name + "-" + suffix))
+	    .string();
 }
 
 template <typename... CString, typename Mod>
@@ -108,17 +74,6 @@ void enable_answers_dollar(args::parser& parser) {
 	parser.use_answer_file('$');
 }
 
-template <typename T, typename U>
-void EQ_impl(T&& lhs, U&& rhs, const char* lhs_name, const char* rhs_name) {
-	if (lhs == rhs) return;
-	std::cerr << "Expected equality of these values:\n " << std::boolalpha
-	          << lhs_name << "\n    Which is: " << lhs << "\n " << rhs_name
-	          << "\n    Which is: " << rhs << "\n";
-	std::exit(1);
-}
-
-#define EQ(lhs, rhs) EQ_impl(lhs, rhs, #lhs, #rhs)
-
 TEST(gen_usage) {
 	return every_test_ever(
 	    [](args::parser& parser) {
@@ -166,7 +121,7 @@ TEST(help_mod) {
 
 TEST_FAIL_OUT(
     no_req,
-    R"(usage: args-help-test [-h] [-o VAR] -r ARG [--on] [--off] [--first ARG ...] --second VAL [--second VAL ...] [INPUT]\nargs-help-test: error: argument -r is required\n)"sv) {
+    R"(usage: args-help-test [-h] [-o VAR] -r ARG [--on] [--off] [--first ARG ...] --second VAL [--second VAL ...] [INPUT]\nargs-help-test: error: argument -r is required\nargument --second is required\n)"sv) {
 	return every_test_ever(noop);
 }
 
@@ -775,3 +730,1447 @@ TEST_FAIL_OUT(
     R"(usage: args-help-test [-h] [-o VAR] -r ARG [--on] [--off] [--first ARG ...] --second VAL [--second VAL ...] [INPUT]\nargs-help-test: error: unrecognized argument: --unexpected\n)"sv) {
 	return every_test_ever(enable_answers, "@unknown-arg");
 }
+
+TEST_FAIL_OUT(
+    answer_file_separator,
+    R"(usage: args-help-test [-h] [-o VAR] -r ARG [--on] [--off] [--first ARG ...] --second VAL [--second VAL ...] [INPUT]\nargs-help-test: error: -- cannot end the options inside an answer file\n)"sv) {
+	return every_test_ever(enable_answers, "@separator-arg");
+}
+
+TEST(instrumentation) {
+	test_args cmd{"--num", "12345", "-v", "@minimal-args"};
+
+	int num{};
+	std::string r{}, s{};
+	size_t reports{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(num, "num");
+	p.custom([] {}, "v");
+	p.arg(r, "r");
+	p.arg(s, "second");
+	p.on_stats([&](args::parse_stats const&) { ++reports; });
+	p.parse();
+
+	auto const& stats = p.stats();
+	if constexpr (args::instrumentation::enabled) {
+		EQ(7u, stats.tokens);
+		EQ(4u, stats.lookups);
+		EQ(3u, stats.conversions);
+		EQ(1u, stats.callbacks);
+		EQ(4u, stats.actions);
+		EQ(3u, stats.value_copies);
+		EQ(1u, stats.answer_files);
+		EQ(1u, reports);
+	} else {
+		EQ(0u, stats.tokens);
+		EQ(0u, stats.lookups);
+		EQ(0u, reports);
+	}
+
+	return 0;
+}
+
+TEST(many_actions) {
+	test_args cmd{"--o99", "99", "--o70=70", "--o3", "3"};
+
+	std::vector<std::string> names;
+	names.reserve(100);
+	int values[100] = {};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	for (size_t index = 0; index < std::size(values); ++index) {
+		names.push_back("o" + std::to_string(index));
+		p.arg(values[index], names.back()).req(index == 70);
+	}
+	p.parse();
+
+	EQ(99, values[99]);
+	EQ(70, values[70]);
+	EQ(3, values[3]);
+	EQ(0, values[4]);
+
+	return 0;
+}
+
+template <typename... CString, typename Mod>
+int constraints_test(Mod mod, CString... args) {
+	bool json{false}, yaml{false}, xml{false};
+	std::optional<std::string> output, format;
+
+	test_args cmd{args...};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.set<std::true_type>(json, "json").opt();
+	p.set<std::true_type>(yaml, "yaml").opt();
+	p.set<std::true_type>(xml, "x").opt();
+	p.arg(output, "o", "output");
+	p.arg(format, "format");
+	mod(p);
+	p.parse();
+	return 0;
+}
+
+void exclusive_formats(args::parser& p) {
+	p.mutually_exclusive({"json", "yaml", "x"});
+}
+
+void all_constraints(args::parser& p) {
+	p.mutually_exclusive({"json", "yaml", "x"});
+	p.at_least_one({"o", "format"});
+	p.depends("json", "output");
+}
+
+TEST(constraints_met) {
+	return constraints_test(all_constraints, "--json", "-o", "out");
+}
+
+TEST_FAIL_OUT(
+    constraints_exclusive,
+    R"(usage: args-help-test [-h] [--json] [--yaml] [-x] [-o ARG] [--format ARG]\nargs-help-test: error: argument --yaml: not allowed with argument --json\nargument -x: not allowed with argument --json\n)"sv) {
+	return constraints_test(exclusive_formats, "-x", "--yaml", "--json");
+}
+
+TEST_FAIL_OUT(
+    constraints_all_reported,
+    R"(usage: args-help-test [-h] [--json] [--yaml] [-x] [-o ARG] [--format ARG]\nargs-help-test: error: argument --yaml: not allowed with argument --json\none of the arguments -o, --format is required\nargument --json requires argument -o\n)"sv) {
+	return constraints_test(all_constraints, "--yaml", "--json");
+}
+
+TEST_FAIL_OUT(
+    constraints_undefined_name,
+    R"(usage: args-help-test [-h] [--json] [--yaml] [-x] [-o ARG] [--format ARG]\nargs-help-test: error: constraint names an undefined argument: --outptu\n)"sv) {
+	return constraints_test(
+	    [](args::parser& p) { p.depends("format", "outptu"); }, "--json");
+}
+
+template <typename... CString, typename Mod>
+int include_test(Mod mod, CString... args) {
+	test_args cmd{args...};
+
+	size_t verbosity{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.custom([&] { ++verbosity; }, "v").opt().multi();
+	mod(p);
+	p.parse();
+
+	EQ(6u, verbosity);
+	if constexpr (args::instrumentation::enabled) {
+		EQ(3u, p.stats().answer_files);
+	}
+	return 0;
+}
+
+TEST(answer_file_include_cache) {
+	return include_test(noop, "@include-outer");
+}
+
+TEST_FAIL_OUT(
+    answer_file_cycle,
+    R"(usage: args-help-test [-h] [-v ...]\nargs-help-test: error: answer file includes itself: cycle-a -> cycle-b -> cycle-a\n)"sv) {
+	return include_test(noop, "@cycle-a");
+}
+
+TEST_FAIL_OUT(
+    answer_file_too_deep,
+    R"(usage: args-help-test [-h] [-v ...]\nargs-help-test: error: answer files nested too deeply: include-outer -> include-inner\n)"sv) {
+	return include_test(
+	    [](args::parser& p) { p.max_answer_file_depth(1); }, "@include-outer");
+}
+
+TEST(stream_positionals) {
+	test_args cmd{"first/path/long/enough/to/allocate", "-v", "second"};
+
+	bool verbose{false};
+	size_t count{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.set<std::true_type>(verbose, "v").opt();
+	auto const on_path = [&](std::string_view path) {
+		if (count++)
+			EQ("second"sv, path);
+		else
+			EQ(static_cast<void const*>(cmd[1]),
+			   static_cast<void const*>(path.data()));
+	};
+	p.stream(on_path).meta("PATH");
+
+	std::string usage;
+	p.printer_append_usage(usage);
+	EQ("args-help-test [-h] [-v] [PATH ...]"sv, usage);
+
+	p.parse();
+	EQ(2u, count);
+	EQ(true, verbose);
+	return 0;
+}
+
+template <typename... CString, typename Check>
+int copy_test(Check check, CString... args) {
+	test_args cmd{args...};
+
+	bool verbose{false};
+	std::vector<std::string> sources;
+	std::string destination;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.set<std::true_type>(verbose, "v").opt();
+	p.arg(sources).meta("SRC").nargs(args::nargs::one_or_more);
+	p.arg(destination).meta("DST");
+	p.parse();
+	check(sources, destination);
+	return 0;
+}
+
+TEST(positional_slots_trailing) {
+	return copy_test(
+	    [](auto const& sources, auto const& destination) {
+		    EQ(3u, sources.size());
+		    EQ("a"s, sources[0]);
+		    EQ("b"s, sources[1]);
+		    EQ("c"s, sources[2]);
+		    EQ("dest"s, destination);
+	    },
+	    "a", "-v", "b", "c", "dest");
+}
+
+TEST(positional_slots_single) {
+	return copy_test(
+	    [](auto const& sources, auto const& destination) {
+		    EQ(1u, sources.size());
+		    EQ("a"s, sources[0]);
+		    EQ("dest"s, destination);
+	    },
+	    "a", "dest");
+}
+
+TEST_FAIL_OUT(
+    positional_slots_missing,
+    R"(usage: args-help-test [-h] [-v] SRC [SRC ...] DST\nargs-help-test: error: argument DST is required\n)"sv) {
+	return copy_test([](auto const&, auto const&) {}, "dest");
+}
+
+template <typename... CString>
+int point_test(CString... args) {
+	test_args cmd{args...};
+
+	std::vector<int> point;
+	std::optional<std::string> label;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(label).meta("LABEL").nargs(args::nargs::optional);
+	p.arg(point).meta("X").nargs(args::nargs::exactly(2));
+	p.parse();
+
+	EQ(2u, point.size());
+	EQ(3, point[0]);
+	EQ(4, point[1]);
+	return 0;
+}
+
+TEST(positional_slots_fixed) {
+	return point_test("3", "4");
+}
+
+TEST(positional_slots_optional_first) {
+	return point_test("origin", "3", "4");
+}
+
+TEST_FAIL_OUT(
+    positional_slots_too_few,
+    R"(usage: args-help-test [-h] [LABEL] X X\nargs-help-test: error: argument X: expected 2 arguments\n)"sv) {
+	return point_test("3");
+}
+
+TEST_FAIL_OUT(
+    positional_slots_too_many,
+    R"(usage: args-help-test [-h] [LABEL] X X\nargs-help-test: error: unrecognized argument: 5\n)"sv) {
+	return point_test("origin", "3", "4", "5");
+}
+
+TEST_FAIL_OUT(
+    positional_slots_single_storage,
+    R"(usage: args-help-test [-h] SRC [SRC ...]\nargs-help-test: error: argument SRC: nargs allows more values than the storage holds\n)"sv) {
+	test_args cmd{"a", "b"};
+
+	std::string source;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(source).meta("SRC").nargs(args::nargs::one_or_more);
+	p.parse();
+	return 0;
+}
+
+TEST(string_view_storage) {
+	test_args cmd{"--name=first", "-p", "path", "input-1", "input-2"};
+
+	std::string_view name;
+	char const* path{};
+	std::optional<std::string_view> missing;
+	std::vector<std::string_view> inputs;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(name, "name");
+	p.arg(path, "p");
+	p.arg(missing, "missing");
+	p.arg(inputs).meta("INPUT");
+	p.parse();
+
+	EQ(static_cast<void const*>(cmd[1] + 7),
+	   static_cast<void const*>(name.data()));
+	EQ("first"sv, name);
+	EQ(static_cast<void const*>(cmd[3]), static_cast<void const*>(path));
+	EQ(false, missing.has_value());
+	EQ(2u, inputs.size());
+	EQ(static_cast<void const*>(cmd[5]),
+	   static_cast<void const*>(inputs[1].data()));
+	return 0;
+}
+
+TEST(string_view_storage_answer_file) {
+	test_args cmd{"@minimal-args"};
+
+	std::string_view req;
+	std::string_view second;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(req, "r");
+	p.arg(second, "second");
+	p.parse();
+
+	// the values still point into the first reading of the file
+	auto const first_req = req;
+	p.parse();
+	EQ("x"sv, first_req);
+	EQ("somsink"sv, second);
+	EQ(static_cast<void const*>(second.data() + second.length()),
+	   static_cast<void const*>(std::strchr(second.data(), '\0')));
+	return 0;
+}
+
+TEST(string_view_storage_kept) {
+	test_args cmd{};
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+
+	std::string temporary{"a value long enough to need the heap"};
+	auto const kept = p.keep(temporary);
+	temporary.assign(temporary.length(), '-');
+	EQ("a value long enough to need the heap"sv, kept);
+	EQ('\0', kept.data()[kept.length()]);
+	return 0;
+}
+
+TEST(release_arena_keeps_last_parse) {
+	auto const path = unique_temp_path("args-arena-test");
+	std::string arg1 = "@" + path;
+	test_args cmd{arg1};
+
+	std::string_view label{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(label, "label");
+
+	std::ofstream{path} << "--label\nfirst\n";
+	p.parse();
+	std::ofstream{path} << "--label\nsecond\n";
+	p.parse();
+	std::filesystem::remove(path);
+
+	p.keep("a value long enough to need the heap");
+	p.release_arena();
+	EQ("second"sv, label);
+	return 0;
+}
+
+namespace {
+	// takes any prefix of "verbose", three letters or longer
+	class prefix_flag final : public args::actions::action_base {
+		bool* dst_;
+
+	public:
+		explicit prefix_flag(bool* dst) : action_base{"verbose"}, dst_{dst} {}
+
+		bool needs_arg() const override { return false; }
+		void visit(args::parser&) override {
+			*dst_ = true;
+			visited(true);
+		}
+		using action_base::visit;
+
+		bool is(std::string_view name) const override {
+			return name.length() > 2 &&
+			       "verbose"sv.substr(0, name.length()) == name;
+		}
+		using action_base::is;
+	};
+}  // namespace
+
+TEST(user_action_is) {
+	test_args cmd{"--verb"};
+
+	bool verbose{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.add_action<prefix_flag>(&verbose);
+	p.parse();
+	EQ(true, verbose);
+	return 0;
+}
+
+namespace {
+	// written against the action interface of the earlier releases
+	class call_counter final : public args::actions::action {
+		size_t* count_;
+		std::vector<std::string> names_{"count", "c"};
+		std::string meta_{};
+		std::string help_{};
+		bool required_{true};
+		bool multiple_{false};
+		bool visited_{false};
+
+	public:
+		explicit call_counter(size_t* count) : count_{count} {}
+
+		bool required() const override { return required_; }
+		void required(bool value) override { required_ = value; }
+		bool multiple() const override { return multiple_; }
+		void multiple(bool value) override { multiple_ = value; }
+		bool needs_arg() const override { return false; }
+		void visit(args::parser&) override {
+			++*count_;
+			visited_ = true;
+		}
+		void visit(args::parser&, std::string const&) override {}
+		bool visited() const override { return visited_; }
+		void meta(std::string_view s) override { meta_ = s; }
+		std::string meta(args::base_translator const&) const override {
+			return meta_;
+		}
+		void help(std::string_view s) override { help_ = s; }
+		std::string const& help() const override { return help_; }
+		bool is(std::string_view name) const override {
+			return name == "count";
+		}
+		bool is(char name) const override { return name == 'c'; }
+		std::vector<std::string> const& names() const override {
+			return names_;
+		}
+	};
+}  // namespace
+
+TEST(user_action_interface) {
+	test_args cmd{"-c", "--count", "-cc"};
+
+	size_t count{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.add_action<call_counter>(&count).opt().multi().help("counts");
+	p.parse();
+	EQ(4u, count);
+
+	std::string usage;
+	p.printer_append_usage(usage);
+	EQ("args-help-test [-h] [--count ...]"sv, usage);
+	return 0;
+}
+
+TEST(copied_names) {
+	test_args cmd{"--temporary-name", "5"};
+
+	int value{};
+	std::string name{"temporary-name"};
+	char meta[] = "META";
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(value, name).meta(meta);
+	name.assign(name.length(), '-');
+	meta[0] = '-';
+
+	std::string usage;
+	p.printer_append_usage(usage);
+	EQ("args-help-test [-h] --temporary-name META"sv, usage);
+
+	p.parse();
+	EQ(5, value);
+	return 0;
+}
+
+TEST(const_array_names) {
+	test_args cmd{"--out", "5"};
+
+	int value{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	{
+		// gone, before the parser reads the name
+		char const name[32] = "out";
+		p.arg(value, name);
+	}
+
+	std::string usage;
+	p.printer_append_usage(usage);
+	EQ("args-help-test [-h] --out ARG"sv, usage);
+
+	p.parse();
+	EQ(5, value);
+	return 0;
+}
+
+TEST(literal_texts) {
+	static char const name[] = "output";
+	args::text const copied{name};
+	args::text const referenced{args::literal{name}};
+	EQ("output"sv, copied.view());
+	EQ("output"sv, referenced.view());
+	EQ(false, copied.view().data() == name);
+	EQ(true, referenced.view().data() == name);
+	return 0;
+}
+
+TEST(frozen_schema) {
+	test_args cmd{};
+
+	std::string output;
+	int level{};
+	bool verbose{};
+	std::vector<std::string> inputs;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(output, "o", "output").meta("FILE").help("output file");
+	p.arg(level, "level").opt();
+	p.set<std::true_type>(verbose, "v", "verbose").opt();
+	p.arg(inputs).meta("INPUT").nargs(args::nargs::one_or_more);
+
+	// the copy stands for an image mapped or embedded elsewhere
+	auto const image = p.freeze();
+	std::vector<char> moved{image.begin(), image.end()};
+	args::schema_view const schema{{moved.data(), moved.size()}};
+
+	EQ(true, schema.valid());
+	EQ(4u, schema.size());
+	EQ(true, schema.provides_help());
+	EQ(0u, schema.find("output"sv));
+	EQ(0u, schema.find('o'));
+	EQ(1u, schema.find("level"sv));
+	EQ(2u, schema.find("verbose"sv));
+	EQ(args::schema_view::npos, schema.find("missing"sv));
+	EQ(args::schema_view::npos, schema.find('x'));
+	EQ(2u, schema.name_count(0));
+	EQ("output"sv, schema.name(0, 1));
+	EQ("FILE"sv, schema.meta(0));
+	EQ("output file"sv, schema.help(0));
+	EQ(true, schema.required(0));
+	EQ(false, schema.required(1));
+	EQ(false, schema.needs_arg(2));
+	EQ(true, schema.positional(3));
+	EQ(args::arity::unbounded, schema.nargs(3).max);
+
+	// an action index out of range reads as nothing
+	EQ(false, schema.needs_arg(100));
+	EQ(""sv, schema.name(100));
+
+	using image_error = args::schema_view::image_error;
+	EQ(true, schema.error() == image_error::none);
+	args::schema_view const broken{{moved.data(), moved.size() - 1}};
+	EQ(false, broken.valid());
+	EQ(true, broken.error() == image_error::size);
+
+	auto const rejected = [&](size_t at, std::uint32_t value) {
+		auto copy = moved;
+		std::memcpy(copy.data() + at * sizeof(value), &value, sizeof(value));
+		return args::schema_view{{copy.data(), copy.size()}}.error();
+	};
+	EQ(true, rejected(args::schema_view::field_byte_order, 0x04030201) ==
+	             image_error::byte_order);
+	EQ(true, rejected(args::schema_view::field_version, 2) ==
+	             image_error::version);
+	// the length of the first name, reaching past the pool
+	auto const first_name = args::schema_view::header_size +
+	                        args::schema_view::short_names_size +
+	                        4 * args::schema_view::action_size;
+	EQ(true, rejected(first_name + 1, 0x10000) == image_error::out_of_range);
+	return 0;
+}
+
+TEST(frozen_schema_scan) {
+	test_args cmd{};
+
+	std::string output;
+	bool verbose{};
+	std::vector<std::string> inputs;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(output, "o", "output");
+	p.set<std::true_type>(verbose, "v").opt();
+	p.arg(inputs).meta("INPUT");
+	auto const image = p.freeze();
+	args::schema_view const schema{image};
+
+	char arg1[] = "-vofile";
+	char arg2[] = "first";
+	char arg3[] = "--unknown";
+	char arg4[] = "second";
+	char* scanned[] = {arg1, arg2, arg3, arg4, nullptr};
+	auto scanner = schema.scan({4, scanned});
+
+	using event = args::schema_view::event;
+	std::vector<event> events{};
+	event ev{};
+	while (scanner.next(ev))
+		events.push_back(ev);
+
+	EQ(5u, events.size());
+	EQ(event::option, events[0].kind);
+	EQ(1u, events[0].action_id);
+	EQ(event::option, events[1].kind);
+	EQ(0u, events[1].action_id);
+	EQ("file"sv, events[1].value);
+	EQ(event::positional, events[2].kind);
+	EQ("first"sv, events[2].value);
+	EQ(event::unknown, events[3].kind);
+	EQ("unknown"sv, events[3].name);
+	EQ(event::positional, events[4].kind);
+	EQ(3u, events[4].index);
+	EQ(true, scanner.violations().empty());
+
+	char* empty[] = {arg2, nullptr};
+	auto partial = schema.scan({1, empty});
+	while (partial.next(ev))
+		;
+	auto const missing = partial.violations();
+	EQ(1u, missing.size());
+	EQ(args::schema_view::violation::required, missing[0].kind);
+	EQ(0u, missing[0].action);
+
+	bool quiet{};
+	p.set<std::true_type>(quiet, "q").opt();
+	p.mutually_exclusive({"v", "q"});
+	p.depends("q", "o");
+	auto const rules_image = p.freeze();
+	args::schema_view const rules{rules_image};
+	EQ(2u, rules.constraint_count());
+	EQ(true, rules.constraint_member(0, 3));
+
+	char arg6[] = "-vq";
+	char* broken[] = {arg6, arg2, nullptr};
+	auto checked = rules.scan({2, broken});
+	while (checked.next(ev))
+		;
+	auto const all = checked.violations();
+	EQ(3u, all.size());
+	EQ(args::schema_view::violation::required, all[0].kind);
+	EQ(args::schema_view::violation::not_allowed_with, all[1].kind);
+	EQ(3u, all[1].action);
+	EQ(1u, all[1].other);
+	EQ(args::schema_view::violation::requires_argument, all[2].kind);
+	EQ(0u, all[2].other);
+
+	char arg5[] = "--";
+	char* ended[] = {arg1, arg5, arg3, nullptr};
+	auto rest = schema.scan({3, ended});
+	events.clear();
+	while (rest.next(ev))
+		events.push_back(ev);
+	EQ(2u, events.size());
+	EQ(1u, rest.rest().size());
+	EQ("--unknown"sv, rest.rest()[0]);
+
+	p.stop_at_positional();
+	auto const stopping_image = p.freeze();
+	args::schema_view const stopping{stopping_image};
+	EQ(true, stopping.stops_at_positional());
+	return 0;
+}
+
+struct bound_options {
+	std::string output;
+	int level{};
+	bool verbose{};
+	std::optional<unsigned> jobs;
+	std::vector<std::string_view> inputs;
+};
+
+constexpr args::struct_schema bound_schema{
+    args::field(&bound_options::output, "output", 'o')
+        .meta("FILE")
+        .help("output file"),
+    args::field(&bound_options::level, "level").opt(),
+    args::field(&bound_options::verbose, 'v'),
+    args::field(&bound_options::jobs, "jobs", 'j'),
+    args::field(&bound_options::inputs).meta("INPUT"),
+};
+
+static_assert(bound_schema.find("level") == 1);
+static_assert(bound_schema.find("output") == 0);
+static_assert(bound_schema.find('j') == 3);
+static_assert(bound_schema.find("verbose") == bound_schema.npos);
+
+template <typename... CString>
+int bound_test(bound_options& opts, CString... args) {
+	test_args cmd{args...};
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	bound_schema.parse(p, opts);
+	return 0;
+}
+
+TEST(bound_struct) {
+	bound_options opts{};
+	bound_test(opts, "-vofile", "first", "--jobs=4", "second", "--level",
+	           "3");
+	EQ("file"s, opts.output);
+	EQ(3, opts.level);
+	EQ(true, opts.verbose);
+	EQ(true, opts.jobs.has_value());
+	EQ(4u, *opts.jobs);
+	EQ(2u, opts.inputs.size());
+	EQ("first"sv, opts.inputs[0]);
+	EQ("second"sv, opts.inputs[1]);
+	return 0;
+}
+
+TEST(bound_struct_answer_file) {
+	auto const path = unique_temp_path("args-bound-test");
+	std::string arg1 = "@" + path;
+	test_args cmd{"-v", arg1, "first", "--", "--level", "4"};
+
+	bound_options opts{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+
+	std::ofstream{path} << "--output\nfile\n-j\n2\n";
+	auto const rest = bound_schema.parse(p, opts);
+	std::filesystem::remove(path);
+
+	EQ("file"s, opts.output);
+	EQ(0, opts.level);
+	EQ(true, opts.verbose);
+	EQ(2u, *opts.jobs);
+	EQ(1u, opts.inputs.size());
+	EQ("first"sv, opts.inputs[0]);
+	EQ(2u, rest.size());
+	EQ("--level"sv, rest[0]);
+	return 0;
+}
+
+TEST_FAIL_OUT(
+    bound_struct_missing,
+    R"(usage: args-help-test [-h] -o FILE [--level ARG] [-v] [-j ARG] INPUT [INPUT ...]\nargs-help-test: error: argument -o is required\n)"sv) {
+	bound_options opts{};
+	return bound_test(opts, "input");
+}
+
+#if !defined(LIBARGS_REGISTRY_UNSUPPORTED)
+namespace {
+	int registered_level{3};
+	bool registered_trace{};
+}  // namespace
+
+ARGS_REGISTER_OPTION(registered_level,
+                     "registered-level",
+                     0,
+                     "level defined away from the parser");
+ARGS_REGISTER_OPTION(registered_trace, "registered-trace", 'T', "traces");
+
+TEST(registered_options) {
+	test_args cmd{"--registered-level", "7"};
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_registry(args::linked_options());
+	p.parse();
+	EQ(7, registered_level);
+
+	p.attach_registered();
+	std::string usage;
+	p.printer_append_usage(usage);
+	EQ("args-help-test [-h] [--registered-level ARG] [-T]"sv, usage);
+	return 0;
+}
+
+TEST_FAIL_OUT(
+    registered_options_in_error_usage,
+    R"(usage: args-help-test [-h] [--registered-level ARG] [-T]\nargs-help-test: error: argument --registered-level: expected a number\n)"sv) {
+	test_args cmd{"--registered-level", "seven"};
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_registry(args::linked_options());
+	p.parse();
+	return 0;
+}
+
+TEST(registered_short_option) {
+	test_args cmd{"-T"};
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_registry(args::linked_options());
+	p.parse();
+	EQ(true, registered_trace);
+	return 0;
+}
+#endif
+
+struct command_state {
+	bool verbose{};
+	unsigned depth{};
+	std::string url{};
+	size_t clones{};
+	size_t inits{};
+};
+
+template <typename... CString>
+int command_test(command_state& state, CString... args) {
+	test_args cmd{args...};
+
+	args::subcommands commands{
+	    {"clone", "clones a repository",
+	     [&](args::parser& p) {
+		     ++state.clones;
+		     p.arg(state.depth, "depth").opt();
+		     p.arg(state.url).meta("URL");
+		     p.parse();
+		     return 0;
+	     }},
+	    {"init", "creates an empty repository",
+	     [&](args::parser& p) {
+		     ++state.inits;
+		     p.parse();
+		     return 1;
+	     }},
+	};
+	commands.common([&](args::parser& p) {
+		p.set<std::true_type>(state.verbose, "v").opt().help("more output");
+	});
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	return commands.run(p);
+}
+
+TEST(subcommands_dispatch) {
+	command_state state{};
+	auto const result =
+	    command_test(state, "-v", "clone", "--depth", "3", "remote");
+	EQ(0, result);
+	EQ(true, state.verbose);
+	EQ(3u, state.depth);
+	EQ("remote"s, state.url);
+	EQ(1u, state.clones);
+	EQ(0u, state.inits);
+	return 0;
+}
+
+TEST(subcommands_common_options) {
+	command_state state{};
+	EQ(1, command_test(state, "init", "-v"));
+	EQ(true, state.verbose);
+	EQ(0u, state.clones);
+	EQ(1u, state.inits);
+	return 0;
+}
+
+TEST_OUT(
+    subcommands_help,
+    R"(usage: args-help-test [-h] [-v] COMMAND ...\n\nprogram description\n\noptional arguments:\n -h, --help show this help message and exit\n -v         more output\n\ncommands:\n clone      clones a repository\n init       creates an empty repository\n)"sv) {
+	command_state state{};
+	return command_test(state, "-h");
+}
+
+TEST_OUT(
+    subcommands_command_help,
+    R"(usage: args-help-test clone [-h] [-v] [--depth ARG] URL\n\nclones a repository\n\npositional arguments:\n URL         \n\noptional arguments:\n -h, --help  show this help message and exit\n -v          more output\n --depth ARG \n)"sv) {
+	command_state state{};
+	return command_test(state, "clone", "--help");
+}
+
+TEST_FAIL_OUT(
+    subcommands_unknown,
+    R"(usage: args-help-test [-h] [-v] COMMAND ...\nargs-help-test: error: unrecognized command: fetch\n)"sv) {
+	command_state state{};
+	return command_test(state, "fetch");
+}
+
+TEST_OUT(
+    subcommands_recursive_help,
+    R"(usage: args-help-test self self [-h]\n       [-v] COMMAND ...\n\nruns the commands again\n\noptional arguments:\n -h, --help show this help message and\n            exit\n -v         more output\n\ncommands:\n self       runs the commands again\n)"sv) {
+	test_args cmd{"self", "self", "--help"};
+
+	bool verbose{};
+	args::subcommands commands{};
+	commands.add({"self", "runs the commands again",
+	              [&](args::parser& p) { return commands.run(p); }});
+	commands.common([&](args::parser& p) {
+		p.set<std::true_type>(verbose, "v").opt().help("more output");
+	});
+
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	return commands.run(p, 40);
+}
+
+TEST(subcommands_copied_names) {
+	test_args cmd{"fetch-all", "--prune"};
+
+	bool prune{};
+	args::subcommands commands{};
+	for (auto const suffix : {"all", "one"}) {
+		auto name = "fetch-"s + suffix;
+		auto help = "fetches "s + suffix;
+		commands.add({name, help, [&](args::parser& p) {
+			              p.set<std::true_type>(prune, "prune").opt();
+			              p.parse();
+			              return 5;
+		              }});
+	}
+
+	EQ("fetches all"sv, commands.find("fetch-all")->help.view());
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	EQ(5, commands.run(p));
+	EQ(true, prune);
+	return 0;
+}
+
+TEST(answer_file_tokens) {
+	args::answer_file_contents contents{};
+	contents.assign(
+	    "# comment\n"
+	    "--name \"two words\" 'single \\ \"quoted\"'\tplain\\ escaped\r\n"
+	    "  --path=C:\\\\Program\\ Files\\\\app \"\" -v # comment -x\n"
+	    "--last",
+	    args::answer_dialect::tokens);
+
+	std::vector<std::string_view> const expected{
+	    "--name"sv,
+	    "two words"sv,
+	    "single \\ \"quoted\""sv,
+	    "plain escaped"sv,
+	    "--path=C:\\Program Files\\app"sv,
+	    ""sv,
+	    "-v"sv,
+	    "--last"sv,
+	};
+	EQ(expected.size(), contents.tokens.size());
+	for (size_t index = 0; index < expected.size(); ++index) {
+		EQ(expected[index], contents.tokens[index]);
+		EQ('\0', contents.tokens[index].data()[expected[index].length()]);
+	}
+	return 0;
+}
+
+TEST(answer_file_dialect) {
+	test_args cmd{"@response-args"};
+
+	std::string_view req;
+	std::vector<std::string> second;
+	size_t verbosity{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file('@', args::answer_dialect::tokens);
+	p.arg(req, "r");
+	p.arg(second, "second");
+	p.custom([&] { ++verbosity; }, "v").opt().multi();
+	p.parse();
+
+	EQ("ANOTHER ONE"sv, req);
+	EQ(2u, second.size());
+	EQ("single quoted"s, second[0]);
+	EQ("escaped space"s, second[1]);
+	EQ(1u, verbosity);
+	return 0;
+}
+
+TEST(answer_file_reload) {
+	auto const path = unique_temp_path("args-reload-test");
+	auto const write = [&](char const* contents) {
+		std::ofstream{path} << contents;
+	};
+	write("--level\n1\n--name\nfirst\n");
+
+	std::string arg1 = "@" + path;
+	test_args cmd{arg1};
+
+	int level{};
+	int names{};
+	std::vector<std::string> changed{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(level, "level");
+	p.custom([&](std::string const&) { ++names; }, "name");
+	p.parse();
+	p.watch_answer_files(
+	    [&](std::vector<std::string> const& names) { changed = names; });
+
+	auto const untouched = p.reload_answer_files();
+	write("--level\n2\n--name\nfirst\n");
+	auto const reloaded = p.reload_answer_files();
+	std::filesystem::remove(path);
+
+	EQ(0u, untouched);
+	EQ(1u, reloaded);
+	EQ(2, level);
+	EQ(1, names);
+	EQ(1u, changed.size());
+	EQ("--level"s, changed[0]);
+	return 0;
+}
+
+TEST(answer_file_reload_replaces) {
+	auto const path = unique_temp_path("args-reload-replace-test");
+	auto const write = [&](char const* contents) {
+		std::ofstream{path} << contents;
+	};
+	write("--include\na\n--include\nb\n--jobs\n4\n-v\n");
+
+	std::string arg1 = "@" + path;
+	test_args cmd{arg1};
+
+	int jobs{1};
+	bool verbose{false};
+	std::vector<std::string> includes{};
+	std::vector<std::string> changed{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(includes, "include").opt();
+	p.arg(jobs, "jobs").opt();
+	p.set<std::true_type>(verbose, "v").opt();
+	p.parse();
+	EQ(2u, includes.size());
+	EQ(4, jobs);
+	EQ(true, verbose);
+
+	p.watch_answer_files(
+	    [&](std::vector<std::string> const& names) { changed = names; });
+	write("--include\nc\n");
+	auto const reloaded = p.reload_answer_files();
+	std::filesystem::remove(path);
+
+	EQ(1u, reloaded);
+	EQ(3u, changed.size());
+	// the list is replaced and the options gone from the file are back to
+	// their defaults
+	EQ(1u, includes.size());
+	EQ("c"s, includes[0]);
+	EQ(1, jobs);
+	EQ(false, verbose);
+	return 0;
+}
+
+TEST(answer_file_reload_errors) {
+	auto const path = unique_temp_path("args-reload-errors-test");
+	auto const write = [&](char const* contents) {
+		std::ofstream{path} << contents;
+	};
+	write("--level\n1\n--label\nfirst\n");
+
+	std::string arg1 = "@" + path;
+	test_args cmd{arg1};
+
+	int level{};
+	std::string_view label{};
+	std::vector<std::string> errors{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(level, "level");
+	p.arg(label, "label");
+	p.parse();
+	p.watch_answer_files({}, [&](std::string const& file,
+	                             std::string const&) { errors.push_back(file); });
+
+	std::vector<size_t> reloaded{};
+	for (auto const contents : {
+	         "--level\nnot-a-number\n--label\nsecond\n",
+	         "--level\n",
+	         "--help\n",
+	         "--level\n2\n--label\nthird\n",
+	         "--level\n3\n--label\nthird\n",
+	     }) {
+		write(contents);
+		reloaded.push_back(p.reload_answer_files());
+	}
+	std::filesystem::remove(path);
+
+	EQ(5u, reloaded.size());
+	EQ(0u, reloaded[0]);
+	EQ(0u, reloaded[1]);
+	EQ(0u, reloaded[2]);
+	EQ(1u, reloaded[3]);
+	EQ(1u, reloaded[4]);
+	EQ(3u, errors.size());
+	EQ(path, errors[0]);
+	EQ(3, level);
+	// the label still points into the text of the fourth version
+	EQ("third"sv, label);
+	return 0;
+}
+
+TEST(parse_events) {
+	test_args cmd{"--level=not-a-number", "-v", "input", "@include-leaf",
+	              "--unknown", "@no-such-file"};
+
+	int level{};
+	size_t verbosity{};
+	std::vector<std::string_view> inputs;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(level, "level");
+	p.custom([&] { ++verbosity; }, "v").opt().multi();
+	p.arg(inputs).meta("INPUT").opt();
+
+	std::vector<args::parse_event> events;
+	for (auto const& event : p.events()) {
+		events.push_back(event);
+		// stopping here leaves the missing answer file unread
+		if (!event.action) break;
+		if (event.name == "v"sv) p.apply(event);
+	}
+
+	EQ(5u, events.size());
+	EQ("level"sv, events[0].name);
+	EQ("not-a-number"sv, events[0].value);
+	EQ(0u, events[0].index);
+	EQ("v"sv, events[1].name);
+	EQ(1u, events[1].index);
+	EQ(""sv, events[2].name);
+	EQ("input"sv, events[2].value);
+	EQ(static_cast<void const*>(cmd[3]),
+	   static_cast<void const*>(events[2].value.data()));
+	EQ("v"sv, events[3].name);
+	EQ(true, events[3].source == args::event_source::answer_file);
+	EQ(0u, events[3].index);
+	EQ(true, events[4].action == nullptr);
+	EQ("unknown"sv, events[4].name);
+	EQ(4u, events[4].index);
+
+	// only the applied events had any effect
+	EQ(2u, verbosity);
+	EQ(0, level);
+	EQ(0u, inputs.size());
+	return 0;
+}
+
+TEST(end_of_options) {
+	test_args cmd{"--opt", "x", "input", "--", "child", "--flags", "--"};
+
+	std::string opt{};
+	std::vector<std::string> inputs{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(opt, "opt");
+	p.arg(inputs).meta("INPUT").opt();
+	auto const rest = p.parse();
+
+	EQ("x"s, opt);
+	EQ(1u, inputs.size());
+	EQ(3u, rest.size());
+	EQ(static_cast<void const*>(cmd.argv() + 5),
+	   static_cast<void const*>(rest.data()));
+	EQ("--flags"sv, rest[1]);
+	return 0;
+}
+
+TEST(stop_at_positional) {
+	test_args cmd{"-s", "TERM", "5", "make", "-s", "@no-such-file"};
+
+	std::string signal{};
+	int duration{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(signal, "s", "signal").opt();
+	p.arg(duration).meta("DURATION");
+	p.stop_at_positional();
+	auto const rest = p.parse();
+
+	EQ("TERM"s, signal);
+	EQ(5, duration);
+	EQ(3u, rest.size());
+	EQ(static_cast<void const*>(cmd.argv() + 4),
+	   static_cast<void const*>(rest.data()));
+	EQ("make"sv, rest[0]);
+	return 0;
+}
+
+TEST(parse_known) {
+	test_args cmd{"-vx1", "--foo=bar", "--level", "3", "in", "out"};
+
+	bool verbose{};
+	int level{};
+	std::string input{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.set<std::true_type>(verbose, "v").opt();
+	p.arg(level, "level");
+	p.arg(input).meta("INPUT");
+	std::vector<args::unknown_arg> unknown{};
+	p.parse_known(unknown);
+
+	EQ(true, verbose);
+	EQ(3, level);
+	EQ("in"s, input);
+	EQ(3u, unknown.size());
+	EQ("-vx1"sv, unknown[0].value);
+	EQ(static_cast<void const*>(cmd[1]),
+	   static_cast<void const*>(unknown[0].value.data()));
+	EQ(0u, unknown[0].index);
+	EQ(2u, unknown[0].offset);
+	EQ("--foo=bar"sv, unknown[1].value);
+	EQ(static_cast<void const*>(cmd[2]),
+	   static_cast<void const*>(unknown[1].value.data()));
+	EQ(1u, unknown[1].index);
+	EQ(0u, unknown[1].offset);
+	EQ("out"sv, unknown[2].value);
+	EQ(5u, unknown[2].index);
+	return 0;
+}
+
+// containers given as temporaries would be gone before the parse
+static_assert(
+    std::is_constructible_v<args::arglist, std::vector<std::string> const&>);
+static_assert(
+    !std::is_constructible_v<args::arglist, std::vector<std::string>>);
+
+TEST(token_ranges) {
+	std::vector<std::string> strings{"tool", "--level", "3", "-v", "in"};
+	std::string_view const views[] = {"--level=4", "in.txt", "--out",
+	                                  "out.txt"};
+
+	int level{};
+	bool verbose{};
+	std::string_view input{};
+	::args::null_translator tr;
+	::args::parser p{"program description", strings, &tr};
+	p.arg(level, "level");
+	p.set<std::true_type>(verbose, "v").opt();
+	p.arg(input).meta("INPUT");
+	p.parse();
+
+	EQ(3, level);
+	EQ(true, verbose);
+	EQ(static_cast<void const*>(strings[4].data()),
+	   static_cast<void const*>(input.data()));
+
+	char const* output{};
+	::args::parser q{"program description", "tool", views, &tr};
+	q.arg(level, "level");
+	q.arg(input).meta("INPUT");
+	q.arg(output, "out");
+	q.parse();
+
+	EQ(4, level);
+	EQ(static_cast<void const*>(views[1].data()),
+	   static_cast<void const*>(input.data()));
+	// string views do not promise a null at their ends
+	EQ("out.txt"sv, output);
+	EQ(false, static_cast<void const*>(views[3].data()) ==
+	              static_cast<void const*>(output));
+	EQ(true, q.args().data() == nullptr);
+	EQ("in.txt"sv, q.args().shift()[0]);
+	return 0;
+}
+
+TEST(resume_with_plugins) {
+	auto const path = unique_temp_path("args-plugin-test");
+	std::ofstream{path} << "--extra-level\n3\n";
+
+	std::string arg7 = "@" + path;
+	test_args cmd{"--plugin", "input", "in.txt", "--plugin", "extra", "-vz",
+	              arg7};
+
+	std::vector<std::string> plugins{};
+	size_t verbosity{};
+	std::string input{};
+	bool zipped{};
+	int level{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_answer_file();
+	p.arg(plugins, "plugin").opt();
+	p.custom([&] { ++verbosity; }, "v").opt().multi();
+
+	size_t loaded{};
+	std::vector<args::parse_event> stops{};
+	auto stream = p.events();
+	while (auto unknown = p.resume(stream)) {
+		stops.push_back(*unknown);
+		for (; loaded < plugins.size(); ++loaded) {
+			if (plugins[loaded] == "input"sv) p.arg(input).meta("INPUT");
+			if (plugins[loaded] == "extra"sv) {
+				p.set<std::true_type>(zipped, "z").opt();
+				p.arg(level, "extra-level");
+			}
+		}
+	}
+	std::filesystem::remove(path);
+
+	EQ(2u, stops.size());
+	EQ(""sv, stops[0].name);
+	EQ("in.txt"sv, stops[0].value);
+	EQ("z"sv, stops[1].name);
+	EQ("in.txt"s, input);
+	EQ(1u, verbosity);
+	EQ(true, zipped);
+	EQ(3, level);
+	return 0;
+}
+
+TEST_FAIL_OUT(
+    resume_without_new_actions,
+    R"(usage: args-help-test [-h] [--plugin ARG]\nargs-help-test: error: unrecognized argument: --unknown\n)"sv) {
+	test_args cmd{"--unknown"};
+
+	std::string plugin{};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(plugin, "plugin").opt();
+
+	auto stream = p.events();
+	while (p.resume(stream)) {
+	}
+	return 0;
+}
+
+template <typename... CString, typename Check>
+int lazy_test(Check check, CString... args) {
+	test_args cmd{args...};
+
+	args::lazy<int> level;
+	args::lazy<unsigned> missing{42};
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.arg(level, "level");
+	p.arg(missing, "missing").opt();
+	p.parse();
+	check(p, level, missing);
+	return 0;
+}
+
+TEST(lazy_conversion) {
+	return lazy_test(
+	    [](args::parser& p, auto const& level, auto const& missing) {
+		    // only the last value is ever converted
+		    EQ("7"sv, level.raw());
+		    if constexpr (args::instrumentation::enabled) {
+			    EQ(0u, p.stats().conversions);
+		    }
+		    EQ(7, *level);
+		    EQ(7, level.get());
+		    if constexpr (args::instrumentation::enabled) {
+			    EQ(1u, p.stats().conversions);
+		    }
+		    EQ(false, missing.has_value());
+		    EQ(42u, *missing);
+	    },
+	    "--level=not-a-number", "--level", "7");
+}
+
+TEST_FAIL_OUT(
+    lazy_conversion_error,
+    R"(usage: args-help-test [-h] --level ARG [--missing ARG]\nargs-help-test: error: argument --level: expected a number\n)"sv) {
+	return lazy_test(
+	    [](args::parser&, auto const& level, auto const&) {
+		    [[maybe_unused]] auto const value = *level;
+	    },
+	    "--level=not-a-number");
+}
+
+// runs each task on a thread of its own, as a pool would
+void thread_executor(size_t count, std::function<void(size_t)> const& task) {
+	std::vector<std::thread> threads{};
+	threads.reserve(count);
+	for (size_t index = 0; index < count; ++index)
+		threads.emplace_back(task, index);
+	for (auto& thread : threads)
+		thread.join();
+}
+
+template <typename Storage>
+std::vector<Storage> const& values_of(
+    args::lazy<std::vector<Storage>> const& values) {
+	return *values;
+}
+
+template <typename Storage>
+std::vector<Storage> const& values_of(std::vector<Storage> const& values) {
+	return values;
+}
+
+template <typename Values, typename Check>
+int bulk_test(size_t count,
+              std::vector<std::pair<size_t, std::string>> const& replaced,
+              Check check) {
+	std::vector<std::string> tokens{"args-help-test"};
+	tokens.reserve(count + 1);
+	for (size_t index = 0; index < count; ++index)
+		tokens.push_back(std::to_string(index * 3));
+	for (auto const& [index, value] : replaced)
+		tokens[index + 1] = value;
+
+	test_args cmd{std::move(tokens)};
+
+	Values values;
+	::args::null_translator tr;
+	::args::parser p{"program description", cmd.view(), &tr};
+	p.use_executor(thread_executor);
+	p.arg(values).meta("VALUE");
+	p.parse();
+	check(values_of(values));
+	return 0;
+}
+
+TEST(bulk_conversion) {
+	static constexpr size_t count = 100000;
+	return bulk_test<args::lazy<std::vector<long long>>>(
+	    count, {}, [](auto const& values) {
+		    EQ(count, values.size());
+		    for (size_t index = 0; index < count; ++index) {
+			    if (values[index] != static_cast<long long>(index * 3)) {
+				    EQ(static_cast<long long>(index * 3), values[index]);
+			    }
+		    }
+	    });
+}
+
+TEST(bulk_conversion_plain_vector) {
+	static constexpr size_t count = 100000;
+	return bulk_test<std::vector<long long>>(
+	    count, {}, [](auto const& values) {
+		    EQ(count, values.size());
+		    for (size_t index = 0; index < count; ++index) {
+			    if (values[index] != static_cast<long long>(index * 3)) {
+				    EQ(static_cast<long long>(index * 3), values[index]);
+			    }
+		    }
+	    });
+}
+
+TEST_FAIL_OUT(
+    bulk_conversion_first_error,
+    R"(usage: args-help-test [-h] VALUE [VALUE ...]\nargs-help-test: error: argument VALUE: number outside of expected bounds\n)"sv) {
+	return bulk_test<args::lazy<std::vector<int>>>(
+	    100000, {{30000, "99999999999999999999"}, {90000, "not-a-number"}},
+	    [](auto const&) {});
+}
+
+TEST_FAIL_OUT(
+    bulk_conversion_plain_vector_first_error,
+    R"(usage: args-help-test [-h] VALUE [VALUE ...]\nargs-help-test: error: argument VALUE: expected a number\n)"sv) {
+	return bulk_test<std::vector<int>>(
+	    100000, {{30000, "not-a-number"}, {90000, "99999999999999999999"}},
+	    [](auto const&) {});
+}
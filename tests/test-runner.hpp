@@ -0,0 +1,118 @@
+// Copyright (c) 2018 midnightBITS
+// This code is licensed under MIT license (see LICENSE for details)
+
+#pragma once
+
+#include <args/parser.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct test {
+	const char* title;
+	int (*callback)();
+	int expected{0};
+	std::string_view output{};
+};
+
+std::vector<test> g_tests;
+
+struct test_program {
+	std::string_view name;
+};
+
+// Command line of a single test: the program name followed by the
+// arguments. The object owns the strings, the argv points into them.
+class test_args {
+	std::vector<std::string> strings_{};
+	std::vector<char*> argv_{};
+
+	void point_argv() {
+		argv_.reserve(strings_.size() + 1);
+		for (auto& arg : strings_)
+			argv_.push_back(arg.data());
+		argv_.push_back(nullptr);
+	}
+
+public:
+	template <typename... Arg>
+	explicit test_args(test_program program, Arg const&... args)
+	    : strings_{std::string{program.name}, std::string{args}...} {
+		point_argv();
+	}
+
+	// the whole command line, with the program name, for generated ones
+	explicit test_args(std::vector<std::string> command_line)
+	    : strings_{std::move(command_line)} {
+		point_argv();
+	}
+
+	template <typename... Arg>
+	explicit test_args(Arg const&... args)
+	    : test_args{test_program{"args-help-test"}, args...} {}
+
+	test_args(test_args const&) = delete;
+	test_args& operator=(test_args const&) = delete;
+
+	int argc() const noexcept { return static_cast<int>(strings_.size()); }
+	char** argv() noexcept { return argv_.data(); }
+	char* operator[](size_t index) noexcept { return argv_[index]; }
+	args::args_view view() noexcept {
+		return args::from_main(argc(), argv());
+	}
+};
+
+template <typename Test>
+struct registrar {
+	registrar() {
+		::g_tests.push_back(
+		    {Test::get_name(), Test::run, Test::expected(), Test::output()});
+	}
+};
+
+#define TEST_BASE(name, EXPECTED, OUTPUT)                            \
+	struct test_##name {                                             \
+		static const char* get_name() noexcept { return #name; }     \
+		static int run();                                            \
+		static int expected() noexcept { return (EXPECTED); }        \
+		static std::string_view output() noexcept { return OUTPUT; } \
+	};                                                               \
+	registrar<test_##name> reg_##name;                               \
+	int test_##name ::run()
+
+#define TEST(name) TEST_BASE(name, 0, {})
+#define TEST_FAIL(name) TEST_BASE(name, 1, {})
+#define TEST_OUT(name, OUTPUT) TEST_BASE(name, 0, OUTPUT)
+#define TEST_FAIL_OUT(name, OUTPUT) TEST_BASE(name, 1, OUTPUT)
+
+int main(int argc, char* argv[]) {
+	if (argc == 1) {
+		for (auto const& test : g_tests) {
+			printf("%d:%s:", test.expected, test.title);
+			if (!test.output.empty())
+				printf("%.*s", static_cast<int>(test.output.size()),
+				       test.output.data());
+			putc('\n', stdout);
+		}
+		return 0;
+	}
+
+	auto const int_test = atoi(argv[1]);
+	if (int_test < 0) return 100;
+	auto const test = static_cast<size_t>(int_test);
+	return g_tests[test].callback();
+}
+
+template <typename T, typename U>
+void EQ_impl(T&& lhs, U&& rhs, const char* lhs_name, const char* rhs_name) {
+	if (lhs == rhs) return;
+	std::cerr << "Expected equality of these values:\n " << std::boolalpha
+	          << lhs_name << "\n    Which is: " << lhs << "\n " << rhs_name
+	          << "\n    Which is: " << rhs << "\n";
+	std::exit(1);
+}
+
+#define EQ(lhs, rhs) EQ_impl(lhs, rhs, #lhs, #rhs)